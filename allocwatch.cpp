@@ -0,0 +1,48 @@
+#include "allocwatch.h"
+
+#ifdef ALLOC_CHECK
+#include <cstdlib>
+#include <new>
+
+static thread_local Uint64 allocations = 0;
+
+Uint64 allocationCount() {
+	return allocations;
+}
+
+//Every form of new goes through these two
+static void* countedAlloc(size_t size) {
+	++allocations;
+	return malloc(size > 0 ? size : 1);
+}
+
+void* operator new(size_t size) {
+	void* p = countedAlloc(size);
+	if(p == NULL) {throw std::bad_alloc();}
+	return p;
+}
+
+void* operator new[](size_t size) {
+	void* p = countedAlloc(size);
+	if(p == NULL) {throw std::bad_alloc();}
+	return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept {free(p);}
+void operator delete[](void* p) noexcept {free(p);}
+
+#else
+
+Uint64 allocationCount() {
+	return 0;
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef ALLOCWATCH_H
+#define ALLOCWATCH_H
+
+#include <SDL2/SDL.h>
+
+//Heap allocations the calling thread has made through operator new so far, so the logger's and other
+//background threads never count against the game's. Only counted in the allocation check builds
+//(make alloccheck, which defines ALLOC_CHECK); always 0 otherwise.
+Uint64 allocationCount();
+
+#endif
@@ -0,0 +1,91 @@
+#include "bundle.h"
+#include "logger.h"
+#include "lz.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+//Unpacked contents by entry; stored entries point straight into the blob
+static vector<const Uint8*> entryData;
+static vector< vector<Uint8> > unpacked;
+
+static int findEntry(const string& path) {
+	for(int i = 0; i < entryData.size(); ++i) {
+		if(path == gBundleEntries[i].name) {return i;}
+	}
+	return -1;
+}
+
+bool unpackBundle() {
+	Uint32 start = SDL_GetTicks();
+	unpacked.assign(gBundleEntryCount, vector<Uint8>());
+	vector<const Uint8*> data(gBundleEntryCount, (const Uint8*) NULL);
+
+	//Entries are biggest first; each thread takes the next one left
+	atomic<int> next(0);
+	atomic<bool> damaged(false);
+	auto work = [&]() {
+		for(int i = next++; i < gBundleEntryCount; i = next++) {
+			const BundleEntry& e = gBundleEntries[i];
+			if(e.packedSize == e.size) {
+				data[i] = gBundleBlob+e.offset;
+				continue;
+			}
+			unpacked[i].resize(e.size);
+			if(lzDecompress(gBundleBlob+e.offset, e.packedSize, unpacked[i].data(), e.size)) {
+				data[i] = unpacked[i].data();
+			} else {
+				damaged = true;
+			}
+		}
+	};
+	int threads = min((int) thread::hardware_concurrency(), gBundleEntryCount);
+	vector<thread> workers;
+	for(int i = 1; i < threads; ++i) {
+		workers.push_back(thread(work));
+	}
+	work();
+	for(int i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+
+	if(damaged) {
+		ERROR_LOG(LOG_ASSETS, "Asset bundle is damaged, loading assets from files");
+		unpacked.clear();
+		return false;
+	}
+	entryData.swap(data);
+	INFO_LOG(LOG_ASSETS, "Unpacked %d bundled assets on %d threads in %u ms", gBundleEntryCount, max(threads, 1), SDL_GetTicks()-start);
+	return true;
+}
+
+SDL_RWops* openAsset(const string& path) {
+	int i = findEntry(path);
+	if(i >= 0) {
+		return SDL_RWFromConstMem(entryData[i], gBundleEntries[i].size);
+	}
+	return SDL_RWFromFile(path.c_str(), "rb");
+}
+
+bool readAsset(const string& path, string& contents) {
+	int i = findEntry(path);
+	if(i >= 0) {
+		contents.assign((const char*) entryData[i], gBundleEntries[i].size);
+		return true;
+	}
+
+	FILE* file = fopen(path.c_str(), "rb");
+	if(file == NULL) {return false;}
+	contents.clear();
+	char buffer[4096];
+	size_t n;
+	while((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		contents.append(buffer, n);
+	}
+	fclose(file);
+	return true;
+}
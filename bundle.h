@@ -0,0 +1,33 @@
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <SDL2/SDL.h>
+#include <string>
+
+using namespace std;
+
+//One packed file. The blob holds packedSize bytes at offset: lz compressed, or stored as is when
+//packedSize == size.
+struct BundleEntry{
+		const char* name;	//Path it was packed from, e.g. "Assets/main.png"
+		Uint32 offset;
+		Uint32 packedSize;
+		Uint32 size;
+};
+
+//The assets and level files, compiled in from bundle_data.cpp, which bundle_pack generates at build time
+extern const Uint8 gBundleBlob[];
+extern const BundleEntry gBundleEntries[];
+extern const int gBundleEntryCount;
+
+//Unpacks every entry, spread over the cores; call once at startup. Until then assets come from files.
+bool unpackBundle();
+
+//An asset by path: the bundled copy if there is one, otherwise the file; NULL if neither.
+//Bundled assets stay in memory, so fonts can keep reading from theirs.
+SDL_RWops* openAsset(const string& path);
+
+//An asset's whole contents, for text files such as maps.txt
+bool readAsset(const string& path, string& contents);
+
+#endif
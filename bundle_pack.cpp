@@ -0,0 +1,84 @@
+//Build step: packs asset files into a C++ source file holding one compressed blob and its index (see bundle.h).
+//Usage: bundle_pack OUTPUT.cpp FILE...; each file is stored under the path it was given as.
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "lz.h"
+
+struct PackedFile{
+		string name;
+		vector<Uint8> data;	//Compressed, or the file itself when compressing doesn't help
+		int size;
+};
+
+static bool readFile(const char* path, vector<Uint8>& data) {
+	FILE* file = fopen(path, "rb");
+	if(file == NULL) {return false;}
+	Uint8 buffer[65536];
+	size_t n;
+	while((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		data.insert(data.end(), buffer, buffer+n);
+	}
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char *args[]) {
+	if(argc < 3) {
+		printf("Usage: bundle_pack OUTPUT.cpp FILE...\n");
+		return 1;
+	}
+
+	vector<PackedFile> files;
+	long long totalSize = 0, totalPacked = 0;
+	for(int i = 2; i < argc; ++i) {
+		PackedFile f;
+		f.name = args[i];
+		vector<Uint8> raw;
+		if(!readFile(args[i], raw)) {
+			printf("Unable to read %s!\n", args[i]);
+			return 1;
+		}
+		f.size = raw.size();
+		f.data = lzCompress(raw.data(), raw.size());
+		if(f.data.size() >= raw.size()) {
+			f.data.swap(raw);
+		}
+		totalSize += f.size;
+		totalPacked += f.data.size();
+		files.push_back(f);
+	}
+
+	//Biggest first, so unpacking threads start on the long jobs
+	stable_sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) {return a.size > b.size;});
+
+	FILE* out = fopen(args[1], "w");
+	if(out == NULL) {
+		printf("Unable to open %s!\n", args[1]);
+		return 1;
+	}
+	fprintf(out, "//Generated by bundle_pack; do not edit\n#include \"bundle.h\"\n\nconst Uint8 gBundleBlob[] = {\n");
+	int column = 0;
+	for(int i = 0; i < files.size(); ++i) {
+		for(int j = 0; j < files[i].data.size(); ++j) {
+			fprintf(out, "%d,", files[i].data[j]);
+			if(++column == 32) {
+				fputc('\n', out);
+				column = 0;
+			}
+		}
+	}
+	fprintf(out, "0\n};\n\nconst BundleEntry gBundleEntries[] = {\n");
+	Uint32 offset = 0;
+	for(int i = 0; i < files.size(); ++i) {
+		fprintf(out, "\t{\"%s\", %u, %u, %u},\n", files[i].name.c_str(), offset, (Uint32) files[i].data.size(), (Uint32) files[i].size);
+		offset += files[i].data.size();
+	}
+	fprintf(out, "};\n\nconst int gBundleEntryCount = %d;\n", (int) files.size());
+	fclose(out);
+
+	printf("Packed %d files, %lld bytes into %lld\n", (int) files.size(), totalSize, totalPacked);
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include "capture.h"
+#include "logger.h"
+
+FrameCapture::FrameCapture():
+	freeCount(0), filledStart(0), filledCount(0), stopping(false), file(NULL), captured(0), dropped(0), written(0) {}
+
+FrameCapture::~FrameCapture() {
+	close();
+}
+
+bool FrameCapture::open(string path) {
+	close();
+
+	file = fopen(path.c_str(), "wb");
+	if(file == NULL) {
+		ERROR_LOG(LOG_IO, "Unable to open %s for capture!", path.c_str());
+		return false;
+	}
+
+	//All memory up front; capturing allocates nothing
+	for(int i = 0; i < BUFFERS; ++i) {
+		buffers[i].resize(FRAME_BYTES);
+		freeList[i] = i;
+	}
+	freeCount = BUFFERS;
+	filledStart = filledCount = 0;
+	stopping = false;
+	captured = dropped = written = 0;
+
+	writer = thread(&FrameCapture::writeFrames, this);
+	INFO_LOG(LOG_IO, "Capturing to %s; encode with: ffmpeg -f rawvideo -pixel_format bgra -video_size %dx%d -framerate %d -i %s -c:v ffv1 match.mkv",
+		path.c_str(), SCREEN_WIDTH, SCREEN_HEIGHT, TICK_RATE, path.c_str());
+	return true;
+}
+
+void FrameCapture::capture() {
+	if(file == NULL) {return;}
+
+	int buffer;
+	{
+		lock_guard<mutex> guard(lock);
+		if(freeCount == 0) {
+			++dropped;
+			return;
+		}
+		buffer = freeList[--freeCount];
+	}
+
+	//The read rectangle is relative to the viewport, so read with the whole window as the viewport
+	SDL_RenderSetViewport(gRenderer, NULL);
+	if(SDL_RenderReadPixels(gRenderer, NULL, SDL_PIXELFORMAT_ARGB8888, buffers[buffer].data(), SCREEN_WIDTH*4) != 0) {
+		ERROR_LOG(LOG_RENDER, "Unable to read back frame! SDL Error: %s", SDL_GetError());
+		lock_guard<mutex> guard(lock);
+		freeList[freeCount++] = buffer;
+		++dropped;
+		return;
+	}
+
+	{
+		lock_guard<mutex> guard(lock);
+		filled[(filledStart+filledCount)%BUFFERS] = buffer;
+		++filledCount;
+		++captured;
+	}
+	wake.notify_one();
+}
+
+void FrameCapture::writeFrames() {
+	unique_lock<mutex> guard(lock);
+	while(true) {
+		wake.wait(guard, [this] {return filledCount > 0 || stopping;});
+		if(filledCount == 0) {break;}	//Stopping and nothing left
+
+		int buffer = filled[filledStart];
+		filledStart = (filledStart+1)%BUFFERS;
+		--filledCount;
+
+		//Write without holding the lock, so capture() can go on
+		guard.unlock();
+		bool ok = fwrite(buffers[buffer].data(), 1, FRAME_BYTES, file) == FRAME_BYTES;
+		guard.lock();
+
+		freeList[freeCount++] = buffer;
+		if(ok) {
+			++written;
+		} else {
+			ERROR_LOG(LOG_IO, "Failed to write captured frame!");
+		}
+	}
+}
+
+void FrameCapture::close() {
+	if(file == NULL) {return;}
+
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_one();
+	writer.join();
+
+	fclose(file);
+	file = NULL;
+	LOG_AT(dropped > 0 ? LOG_LEVEL_WARN : LOG_LEVEL_INFO, LOG_IO, "Capture: %d frames captured, %d written, %d dropped", captured, written, dropped);
+}
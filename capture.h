@@ -0,0 +1,56 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game.h"
+
+//Records the game to a raw video file (--capture). Each captured frame is read back from the renderer into one
+//of a few reusable buffers and handed to a writer thread, so the game never waits for the disk. If the writer
+//falls behind and every buffer is in use, the frame is dropped and counted instead.
+//The file is bare BGRA frames of SCREEN_WIDTH x SCREEN_HEIGHT; ffmpeg -f rawvideo can encode it losslessly.
+class FrameCapture{
+		static const int BUFFERS = 8;
+		static const int FRAME_BYTES = SCREEN_WIDTH*SCREEN_HEIGHT*4;
+
+		vector<Uint8> buffers[BUFFERS];
+
+		//Buffer indices by state; guarded by lock
+		int freeList[BUFFERS];
+		int freeCount;
+		int filled[BUFFERS];	//Waiting to be written, oldest first
+		int filledStart, filledCount;
+		bool stopping;
+
+		mutex lock;
+		condition_variable wake;
+		thread writer;
+		FILE* file;
+
+		void writeFrames();
+
+	public:
+		int captured;	//Frames handed to the writer
+		int dropped;	//Frames skipped because no buffer was free
+		int written;
+
+		FrameCapture();
+		~FrameCapture();
+
+		bool open(string path);
+		bool isOpen() {return file != NULL;}
+
+		//Reads back what has been rendered so far this frame; call before SDL_RenderPresent
+		void capture();
+
+		//Writes out what is queued, stops the writer and prints the frame counts
+		void close();
+};
+
+#endif
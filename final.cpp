@@ -4,325 +4,113 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
-#include <iostream>
 #include <random>
-#include <sstream>
 #include <string>
 #include <vector>
 
-#define PI 3.14159265
+#include "allocwatch.h"
+#include "bundle.h"
+#include "capture.h"
+#include "framearena.h"
+#include "game.h"
+#include "logger.h"
+#include "net.h"
+#include "particles.h"
+#include "renderqueue.h"
+#include "telemetry.h"
+#include "tilecanvas.h"
 
-using namespace std;	//FINALLY!!! <3
-
-//Screen dimension constants
-const int SCOREBOARD_HEIGHT = 60;
-const int PLAYFIELD_HEIGHT = 540;
-
-const int SCREEN_WIDTH = 1170;
-const int SCREEN_HEIGHT = SCOREBOARD_HEIGHT+PLAYFIELD_HEIGHT;
-
-enum Tiles{
-	GRASS, BRICK, WATER, STEEL, SLIDE_DOWN, SLIDE_LEFT, SLIDE_UP, SLIDE_RIGHT, TOTAL_TILES
-};
-
-enum Directions{
-	SOUTH, WEST, NORTH, EAST, TOTAL_DIRECTIONS
-};
-
-enum Controls{
-	UP, LEFT, DOWN, RIGHT, SHOOT, PLACEBOMB
-};
-
-enum PowerUps{
-	LIFE, BOMB, SHIELD, BULLETUPGRADE, SPEEDUP
-};
-
-struct Circle{
-		int x, y;
-		int r;
+class Score{
+    public:
+        string name;
+        int score;
+        Score(string playerName, int playerScore);
 };
 
-class LTexture{
-   		//The actual hardware texture
-		SDL_Texture* mTexture;
-
-		//Image dimensions
-		int mWidth;
-		int mLength;
+//Keypress-to-present latency: each press is timed from its event timestamp until the first
+//frame presented after the tick it was applied to
+class LatencyMeter{
+		static const int MAX_PENDING = 64;
+		static const int BUCKETS = 250;	//One per millisecond; slower presses go in the last one
+
+		Uint32 pending[MAX_PENDING];	//Presses waiting for their tick, oldest first
+		int pendingCount;
+		Uint32 applied[MAX_PENDING];	//Presses whose tick has run, waiting for the next present
+		int appliedCount;
+		int histogram[BUCKETS];
+		int samples;
+		Uint64 total;
+		Uint32 worst;
 
 	public:
-		//Initialize variables
-		LTexture();
-
-		//Deallocates memory
-		~LTexture();
-
-		//Loads image at specified path
-		bool loadFromFile(string);
-
-		#ifdef _SDL_TTF_H
-		//Creates image from font string
-		bool loadFromRenderedText(string, SDL_Color);
-		#endif
-
-		//Deallocates texture
-		void free();
+		LatencyMeter();
 
-		//Set color modulation
-		void setColor(Uint8, Uint8, Uint8);
+		void keyPressed(Uint32 timestamp);
+		void tickRan(Uint32 tickEnd);
+		void presented(Uint32 time);
 
-		//Set blending
-		void setBlendMode(SDL_BlendMode);
-
-		//Set alpha modulation
-		void setAlpha(Uint8 alpha);
-
-		//Renders texture at given point
-		void render(SDL_Rect*, SDL_Rect* = NULL, double = 0.0, SDL_Point* = NULL, SDL_RendererFlip = SDL_FLIP_NONE);
-		void render(int, int, SDL_Rect* = NULL, double = 0.0, SDL_Point* = NULL, SDL_RendererFlip = SDL_FLIP_NONE);
-
-		//Gets image dimensions
-		int getWidth();
-		int getLength();
+		//Prints the count, mean, percentiles and maximum
+		void report();
 };
 
-class LTimer{
-	    //The clock time when the timer started
-		Uint32 mStartTicks;
-
-		//The ticks stored when the timer was paused
-		Uint32 mPausedTicks;
-
-	public:
-		//The timer status
-		bool mPaused;
-		bool mStarted;
-		//Initializes variables
-		LTimer();
-
-		//The various clock actions
-		void start();
-		void stop();
-		void pause();
-		void unpause();
-
-		//Gets the timer's time
-		Uint32 getTicks();
-
-		//Checks the status of the timer
-		bool isStarted();
-		bool isPaused();
+enum PacingModes{
+	VSYNC, ADAPTIVE_VSYNC, UNCAPPED, LIMITED
 };
 
-class Tile{
-		int tileType;	//Used to determine the reaction of the tile
-		int walkability;	//The level of mobility a player needs to have to traverse the tile
-		int direction;	//Only really used for SLIDE tiles; determines the rotation of the tile/where the tile is facing
-		vector<SDL_Rect> renderSrc;	//The area of the texture/s to be rendered
-		
-	public:
-		static const int HEIGHT = 30, WIDTH = 30;
-		
-		Tile(int tileType):
-			tileType(tileType), direction(0) {
-				switch(tileType) {
-					case GRASS:
-						renderSrc.push_back({0, 0, 32, 32});
-						walkability = 0;
-						break;
-					case BRICK:
-						renderSrc.push_back({32, 0, 32, 32});
-						walkability = 2;
-						break;
-					case WATER:
-						renderSrc.push_back({64, 0, 32, 32});
-						walkability = 1;
-						break;
-					case STEEL:
-						renderSrc.push_back({96, 0, 32, 32});
-						walkability = 3;
-						break;
-					case SLIDE_DOWN: case SLIDE_LEFT: case SLIDE_UP: case SLIDE_RIGHT:
-						if(tileType == SLIDE_DOWN) {direction = SOUTH;}
-						if(tileType == SLIDE_LEFT) {direction = WEST;}
-						if(tileType == SLIDE_UP) {direction = NORTH;}
-						if(tileType == SLIDE_RIGHT) {direction = EAST;}
-						for(int i = 0; i < 4; ++i) {
-							renderSrc.push_back({32*i, 32, 32, 32});
-						}
-						walkability = 0;
-						break;
-				}
-			};
-		
-		int getTileType();
-		int getWalkability();
-		int getDirection();
-		void render(int, SDL_Rect);
-};
-
-class Map{
-		SDL_Rect t;
-	
- 	public:
-		static const int ROWS = PLAYFIELD_HEIGHT/Tile::HEIGHT, COLS = SCREEN_WIDTH/Tile::WIDTH;
-		
-		Map();
-		
-		Tile* tileMap[COLS][ROWS];
-		
-		Tile* tile(int, int);
-		void hit(int, int);
-		void render(int);
-};
-
-class Bullet{
-	public:
-		static const int HEIGHT = 5, WIDTH = 5, VEL = 5;
-		double x, y, w, h;
-
-		int dir;
-		SDL_Rect bullet;
-
-		Bullet(double xStart, double yStart, int direction):
-			x(xStart), y(yStart), w(WIDTH), h(HEIGHT), dir(direction) {};
-
-		bool move();
-		bool move(Uint32 t);
-		void render();
-		bool blanks();
-};
+//Paces presented frames and keeps frame time statistics, all on the performance counter.
+//LIMITED sleeps for most of the wait and spins the rest, since sleeps can overshoot by a millisecond or more.
+class FramePacer{
+		static const int SPIN_MICROSECONDS = 2000;	//Final part of the wait spent spinning
 
-class Player{    
+		int mode;
+		Uint64 frequency;
+		Uint64 period;	//Counter ticks per frame when LIMITED
+		Uint64 deadline;
+		Uint64 lastPresent;
 
-	int dir;
-	int lifeXPos;
-	LTexture* playerTex;
-	LTexture* playerLifeTex;
-	Circle collider;
-	SDL_Scancode con[6];
-	bool wasPreviouslyOnSlidewalk;	//Used to check entry and exit of SLIDE tile
-	SDL_Rect lastEnteredSlidewalk;
-	
-	void react();
+		//Frame times in milliseconds
+		int frames;
+		double sum, sumSquares;
+		double shortest, longest;
 
 	public:
-		static const int WIDTH = 20, HEIGHT = 20;
-		static const int SHIELD_DURATION = 10;
-		static const int BOMB_DURATION = 50;
-		SDL_Rect playerRect;
-
-		int score = 0;
-		int life = 5;
-		int vel = 2;
-        bool shieldEnable;
-        bool bulletUpEnable;
-    	bool bombEnable;
-    	bool collisionReady;
-        LTimer shieldTimer;
-        LTimer bombTimer;
-
-		Player(LTexture* texture, int lifeAvailableXPos, int x, int y, bool enableBombUp, bool enableBulletUp, bool enableShieldUp, SDL_Scancode up, SDL_Scancode left, SDL_Scancode down, SDL_Scancode right, SDL_Scancode shoot, SDL_Scancode placebomb):
-			playerRect{x, y, texture->getWidth(), texture->getLength()},
-			dir(SOUTH), playerTex(texture), collider{x+WIDTH/2,y+WIDTH/2,WIDTH/2}, bombEnable(enableBombUp), bulletUpEnable(enableBulletUp), shieldEnable(enableShieldUp), lifeXPos(lifeAvailableXPos), con{up, left, down, right, shoot, placebomb},
-			wasPreviouslyOnSlidewalk(false), lastEnteredSlidewalk{0, 0, 0, 0} {};
-
-		void act(const Uint8*);
-		void act(SDL_Scancode);
-		void move(int, int);
-
-		Circle& getCollider();
-		void shiftColliders();
-		void render();
-		void renderLifeTexture();
-		void activatePowerUp(int id, SDL_Rect& Rect);
-		void placeBomb();
-		void shoot();
-
-};
+		FramePacer(int mode, int fps);
 
-class PowerUp{
- 	public:
- 		static const int WIDTH = 20, HEIGHT = 20;
-	 	int id;
-		Circle collider;
+		//Blocks until the next frame is due; does nothing unless LIMITED
+		void wait();
 
-		LTexture* powerUpTex;
-		//Rect is changed to public
-	    SDL_Rect powerUpRect;
-		PowerUp(LTexture* texture, int pwrUp_id);
+		//Call right after SDL_RenderPresent
+		void presented();
 
-		void render();
-		Circle& getCollider();
-		int getPowerUpID();
+		//Prints frame count, mean frame time and its jitter (standard deviation, min, max)
+		void report();
 };
 
-class Bomb{
-		Circle collider;
-		
-    public:
-        static const int WIDTH = 20, HEIGHT = 20;
-        static const int TIMER = 3;
-
-        LTimer timer;
-        int bombPosX, bombPosY;
-        int scope;
-        bool start;
-
-        Bomb(int x, int y):
-            bombPosX(x), bombPosY(y), collider{x+Player::WIDTH-(x+Player::WIDTH)%Tile::WIDTH+Tile::WIDTH/2, y+Player::HEIGHT-(y+Player::HEIGHT)%Tile::HEIGHT+Tile::HEIGHT/2, WIDTH/2}, scope(1), start(false) {timer.start();};
-        Circle& getCollider();
-		void shiftColliders();
-        void render();
-        void renderExplosion();
-        void blowUp(int x, int y);
-};
+//Starts up SDL and creates window; vsync or not depending on the pacing mode
+bool init(int pacing);
 
-class Enemy{
-		Circle collider;
-		
-	public:
-		static const int WIDTH = 16, HEIGHT = 16;
-		int posX, posY, angle, vx, vy, path;
-		bool initDir;
-
-		Enemy();
-		Circle& getCollider();
-		void shiftColliders();
-		void shoot();
-		void move(Uint32 t);
-		//Flag for enemy - player collision
-		bool collisionReady;
-		void hit();
-		void render();
-};
+//Loads media
+bool loadMedia();
 
-class Score{
-    public:
-        string name;
-        int score;
-        Score(string playerName, int playerScore);
-};
+//Reads a recording made with --record: the seed and each player's inputs
+bool loadReplay(string path, Uint32& seed, vector< vector<Uint8> >& inputs);
 
-//Starts up SDL and creates window
-bool init();
+//Draws the scoreboard and the playfield
+void renderGame(GameWorld&);
 
-//Loads media
-bool loadMedia();
+//Width of a scoreboard line: its label followed by a number
+int hudLineWidth(LTexture& label, int value);
 
-//Collision checkers
-bool checkCollision(Circle& c1, Circle& c2);
-bool checkCollision(Circle& c1, SDL_Rect r);
-bool checkBombCollide(Circle& player);
-bool checkEnemyCollide(Circle& player, int*, bool collisionReady);
-bool checkIfEnclosed(SDL_Rect& smallerArea, SDL_Rect& largerArea);
+//Draws a scoreboard line from x, centred in the scoreboard's height
+void renderHudLine(LTexture& label, int value, int x);
 
-//Gets grass tiles x and y pos and stores in x and y vectors
-void getGrassTilesPos();
+//Draws a number with its digits scaled to the given height; returns its width
+int renderSmallNumber(int value, int x, int y, int height);
 
-//Reset game
-void restart();
+//Draws tiles flat out through SDL_Renderer and then through the tile canvas, and prints both frame times
+void benchmarkTiles();
 
 //sorts score in text file
 bool sortByScore(const Score &lhs,const Score &rhs);
@@ -330,75 +118,43 @@ bool sortByScore(const Score &lhs,const Score &rhs);
 //Frees media and shuts down SDL
 void close();
 
-//The window renderer
-SDL_Renderer* gRenderer = NULL;
-
 //The window we'll be rendering to
 SDL_Window* gWindow = NULL;
 
-//Globally used font
-TTF_Font* gFont = NULL;
-
 //Textures
-LTexture gPlayerOneTexture;
-LTexture gPlayerTwoTexture;
-LTexture gEnemyTexture;
-
-LTexture gBombPowerUPTexture;
-LTexture gShieldTexture;
-LTexture gLifeTexture;
-LTexture gBulletUpgradeTexture;
-LTexture gSpeedUpTexture;
-
-LTexture gPlayer1ScoreTexture;
-LTexture gPlayer2ScoreTexture;
-LTexture gTimeTextTexture;
+//Scoreboard text, rendered once at load: a label per line, and the digits the numbers are drawn with
+LTexture gTimeLabelTexture;
+LTexture gPlayer1LabelTexture;
+LTexture gPlayer2LabelTexture;
+LTexture gDigitTextures[10];
 LTexture gMainTexture;
 LTexture gPlayerOneWins;
 LTexture gPlayerTwoWins;
-LTexture gLifeAvailableTexture;
+LTexture gPlayerWinsTexture;	//"Player N wins!" for the players past the second, who have no screen of their own
+int gPlayerWinsShown = -1;	//The player it was rendered for
 
-LTexture gBombTexture;
-LTexture gExplosionTexture;
 LTexture gPauseTexture;
 LTexture gWinnerNameTexture;
 
-LTexture gSpriteSheet;
-Tile* gTiles[TOTAL_TILES];
-
-//Timers
-LTimer gTimer;
-LTimer gDsplyPwrUpsTimer;
+//One controller per player
+vector<Controller*> gControllers;
 
-//Vectors
-vector<Map> gLevels;
-vector<Player> gPlayers;
-vector<Bullet> gBullets;
-vector<PowerUp> gPowerUps;
-vector<Enemy> gEnemies;
-vector<Bullet> gEnemyBullets;
-vector<Bomb> gBomb;
-vector<int> xTile;
-vector<int> yTile;
+//Explosion and impact particles
+ParticleSystem gParticles;
 
-//Rand device
-random_device type;
+//CPU tile drawing, used instead of a RenderCopyEx per tile when gCpuTiles is set
+TileCanvas gTileCanvas;
+bool gCpuTiles = false;
 
-//Initializes the current level
-int gLevel = 0;	//Note: program crashes for some reason if set to 1
-const int LEVELS = 3;	//Number of levels to be created (Now 3)
+//Match video, when started with --capture
+FrameCapture gCapture;
 
-//For resetting the game
-bool reset = false;
+//Match events, when started with --telemetry
+TelemetryStream gTelemetry;
 
-//For pausing the game
-bool disableCon = false;
-
-//frame counter
-int frame = 0;
-
-//For reading the map layout
-ifstream mapReader("maps.txt");
+//Network match, when started with --net
+NetSession gNetSession;
+bool netplay = false;
 
 //For the high score
 ifstream myfile_Read("score.txt");
@@ -422,67 +178,243 @@ vector<int> intScore;
 vector<Score> highScore;
 
 int main(int argc, char *args[]) {
+	//Network match options
+	int netPlayer = 0, localPort = 0, remotePort = 0;
+	const char* peerHost = NULL;
+	int latency = 0, jitter = 0, loss = 0;
+	Uint32 seed = random_device()();
+	bool seedGiven = false;
+
+	//Horde mode: enemies kept on the field, 0 for none
+	int hordeSize = 0;
+
+	//Controller options
+	int playerCount = 2;
+	vector<bool> bots(MAX_PLAYERS, false);
+	const char* recordPath = NULL;
+	const char* replayPath = NULL;
+
+	//Input latency instrumentation
+	bool measureLatency = false;
+	LatencyMeter latencyMeter;
+
+	//Frame pacing options
+	int pacing = VSYNC;
+	int fps = 60;
+	bool frameStats = false;
+
+	//Tile drawing: auto, sdl or cpu
+	string tileRenderer = "auto";
+	bool renderBench = false;
+	bool renderStats = false;
+
+	//Match video file
+	const char* capturePath = NULL;
+
+	//Match event file
+	const char* telemetryPath = NULL;
+
+	//Rotating log of errors and game events
+	const char* logPath = "game.log";
+
+	//Set by the allocation check build when a frame of play allocated
+	bool allocFailed = false;
+
+	for(int i = 1; i < argc; ++i) {
+		string arg = args[i];
+		if(arg == "--net" && i+4 < argc) {
+			//--net <player 0|1> <local port> <peer host> <peer port>
+			netplay = true;
+			netPlayer = atoi(args[i+1]) == 1 ? 1 : 0;
+			localPort = atoi(args[i+2]);
+			peerHost = args[i+3];
+			remotePort = atoi(args[i+4]);
+			i += 4;
+		} else if(arg == "--latency" && i+1 < argc) {
+			latency = atoi(args[++i]);
+		} else if(arg == "--jitter" && i+1 < argc) {
+			jitter = atoi(args[++i]);
+		} else if(arg == "--loss" && i+1 < argc) {
+			loss = atoi(args[++i]);
+		} else if(arg == "--seed" && i+1 < argc) {
+			seed = strtoul(args[++i], NULL, 10);
+			seedGiven = true;
+		} else if(arg == "--players" && i+1 < argc) {
+			//--players <2-8>: slots are taken from players.txt in order
+			playerCount = min(max(atoi(args[++i]), 2), MAX_PLAYERS);
+		} else if(arg == "--horde" && i+1 < argc) {
+			hordeSize = max(atoi(args[++i]), 0);
+		} else if(arg == "--bot" && i+1 < argc) {
+			//--bot <player 0-7>: the computer plays that side
+			int player = atoi(args[++i]);
+			if(player >= 0 && player < MAX_PLAYERS) {bots[player] = true;}
+			else {WARN_LOG(LOG_SYSTEM, "No player %d to hand to a bot", player);}
+		} else if(arg == "--record" && i+1 < argc) {
+			recordPath = args[++i];
+		} else if(arg == "--replay" && i+1 < argc) {
+			replayPath = args[++i];
+		} else if(arg == "--measure-latency") {
+			measureLatency = true;
+		} else if(arg == "--pacing" && i+1 < argc) {
+			//--pacing <vsync|adaptive|uncapped|limit>
+			string mode = args[++i];
+			if(mode == "vsync") {pacing = VSYNC;}
+			else if(mode == "adaptive") {pacing = ADAPTIVE_VSYNC;}
+			else if(mode == "uncapped") {pacing = UNCAPPED;}
+			else if(mode == "limit") {pacing = LIMITED;}
+			else {WARN_LOG(LOG_SYSTEM, "Unknown pacing mode %s", mode.c_str());}
+		} else if(arg == "--fps" && i+1 < argc) {
+			//Frame rate of the limiter; implies --pacing limit
+			fps = max(atoi(args[++i]), 1);
+			pacing = LIMITED;
+		} else if(arg == "--frame-stats") {
+			frameStats = true;
+		} else if(arg == "--renderer" && i+1 < argc) {
+			//--renderer <auto|sdl|cpu>
+			tileRenderer = args[++i];
+			if(tileRenderer != "auto" && tileRenderer != "sdl" && tileRenderer != "cpu") {
+				WARN_LOG(LOG_SYSTEM, "Unknown renderer %s", tileRenderer.c_str());
+				tileRenderer = "auto";
+			}
+		} else if(arg == "--log" && i+1 < argc) {
+			logPath = args[++i];
+		} else if(arg == "--telemetry" && i+1 < argc) {
+			telemetryPath = args[++i];
+		} else if(arg == "--capture" && i+1 < argc) {
+			capturePath = args[++i];
+		} else if(arg == "--render-stats") {
+			renderStats = true;
+		} else if(arg == "--render-bench") {
+			//Frame rates are only comparable without vsync
+			renderBench = true;
+			pacing = UNCAPPED;
+		} else {
+			WARN_LOG(LOG_SYSTEM, "Unknown option %s", args[i]);
+		}
+	}
+
+	gLogger.open(logPath);
+	unpackBundle();
+
+	//A replay brings its own seed and inputs
+	vector< vector<Uint8> > replayInputs;
+	if(replayPath != NULL && !loadReplay(replayPath, seed, replayInputs)) {
+		ERROR_LOG(LOG_IO, "Unable to read replay %s!", replayPath);
+		gLogger.close();
+		return 1;
+	}
+
+	//Both ends of a network match have to roll the same numbers
+	if(netplay && !seedGiven) {seed = 1;}
+
+	//A replay was made with its own number of players; a network match has one on each end
+	if(replayPath != NULL) {
+		playerCount = replayInputs.size();
+	} else if(netplay && playerCount != 2) {
+		WARN_LOG(LOG_NET, "Network matches are for two players");
+		playerCount = 2;
+	}
+
 	//Start up SDL and create window
-	if(!init()) {
-		printf("Failed to initialize!\n");
+	if(!init(pacing)) {
+		ERROR_LOG(LOG_SYSTEM, "Failed to initialize!");
 	} else {
 		//Load media
 		if(!loadMedia()) {
-			printf("Failed to load media!\n");
+			ERROR_LOG(LOG_ASSETS, "Failed to load media!");
 		}
 		else{
-			int levelDuration = 60;
+			//Draw tiles on the CPU when asked to, or when SDL could only give us its software renderer
+			SDL_RendererInfo info;
+			bool softwareRenderer = SDL_GetRendererInfo(gRenderer, &info) == 0 && (info.flags & SDL_RENDERER_SOFTWARE);
+			gCpuTiles = tileRenderer == "cpu" || (tileRenderer == "auto" && softwareRenderer);
+			if(gCpuTiles && !gTileCanvas.load("Assets/terrain.png")) {
+				WARN_LOG(LOG_RENDER, "Failed to set up CPU tile drawing, using SDL_Renderer!");
+				gCpuTiles = false;
+			}
 
 			//Main loop flags
 			bool quit = false;
 			bool start = false;
 			bool paused = false;
-			bool gameOver = false;
-
-			//initial player values
-			bool enableBombUp = false;
-			bool enableBulletUp = false;
-			bool enableShieldUp = false;
-			int p1LifeAvailablePosX = 60;
-			int p2LifeAvailablePosX = SCREEN_WIDTH-SCREEN_WIDTH/6;
-			int p1_posX = 5, p1_posY = 5, p2_posX = SCREEN_WIDTH-Player::WIDTH-5, p2_posY = PLAYFIELD_HEIGHT-Player::HEIGHT-5;
-
-			//Level initialization
-			for(int i = 0; i < LEVELS; ++i) {
-				gLevels.emplace_back();
+
+			if(renderBench) {
+				benchmarkTiles();
+				quit = true;
+			}
+
+			//One captured frame per tick of play
+			if(capturePath != NULL) {
+				gCapture.open(capturePath);
 			}
+			int capturedTick = -1;
 
-			getGrassTilesPos();
+			//The match: levels, players and everything else that moves
+			GameWorld world(seed, playerCount);
+			if(world.players.size() < playerCount) {
+				WARN_LOG(LOG_SYSTEM, "players.txt only has slots for %d players", (int) world.players.size());
+			}
+			if(hordeSize > 0) {
+				world.startHorde(hordeSize);
+				gRenderQueue.reserve(hordeSize+4096);
+			}
 
-			//Create players
-			gPlayers.emplace_back(&gPlayerOneTexture, p1LifeAvailablePosX, p1_posX, p1_posY, enableBombUp, enableBulletUp, enableShieldUp, SDL_SCANCODE_W, SDL_SCANCODE_A, SDL_SCANCODE_S, SDL_SCANCODE_D, SDL_SCANCODE_C, SDL_SCANCODE_X);
-			gPlayers.emplace_back(&gPlayerTwoTexture, p2LifeAvailablePosX, p2_posX, p2_posY, enableBombUp, enableBulletUp, enableShieldUp, SDL_SCANCODE_I, SDL_SCANCODE_J, SDL_SCANCODE_K, SDL_SCANCODE_L, SDL_SCANCODE_N, SDL_SCANCODE_M);
+			//Create controllers; keys come from each player's slot
+			for(int i = 0; i < world.players.size(); ++i) {
+				SDL_Scancode* keys = gPlayerSlots[i].keys;
+				if(replayPath != NULL) {
+					gControllers.push_back(new ReplayController(replayInputs[i]));
+				} else if(bots[i]) {
+					gControllers.push_back(new BotController(seed^(0x9E3779B9*(i+1))));
+				} else {
+					gControllers.push_back(new KeyboardController(keys[UP], keys[LEFT], keys[DOWN], keys[RIGHT], keys[SHOOT], keys[PLACEBOMB]));
+				}
+			}
 
-			//Power ups variables
-			static const int NSETS = 8;
-			static const int NPOWERUPS = 5;
-			static const int DSPLYTIMEPWRUP = 10;
+			//Recording: seed and player count, then every tick's inputs
+			FILE* recordFile = NULL;
+			if(recordPath != NULL && !netplay) {
+				recordFile = fopen(recordPath, "wb");
+				if(recordFile == NULL) {
+					ERROR_LOG(LOG_IO, "Unable to open %s for recording!", recordPath);
+				} else {
+					Uint8 header[9] = {'B', 'M', 'R', 'P', (Uint8) seed, (Uint8) (seed >> 8), (Uint8) (seed >> 16), (Uint8) (seed >> 24), (Uint8) world.players.size()};
+					fwrite(header, 1, sizeof(header), recordFile);
+				}
+			}
 
-            //LIFE, BOMB, SHIELD, BULLETUPGRADE, SPEEDUP
-			static const int powerUpsSet[NSETS][NPOWERUPS] = {{0, 2, 0, 1, 2}, {0, 2, 0, 0, 1}, {2, 0, 1, 0, 1}, {1, 0, 2, 0, 2}, {0, 0, 0, 2, 2}, {1, 3, 0, 1, 1}, {0, 0, 1, 1, 2}, {3, 0, 0,1, 2}};
-			LTexture powerUpsTex[NPOWERUPS] = {gLifeTexture, gBombPowerUPTexture, gShieldTexture, gBulletUpgradeTexture, gSpeedUpTexture};
+			//Rollback re-simulates ticks, which would record their events twice
+			if(telemetryPath != NULL && netplay) {
+				WARN_LOG(LOG_IO, "Telemetry is not recorded in network matches");
+			} else if(telemetryPath != NULL && gTelemetry.open(telemetryPath)) {
+				world.attachTelemetry(&gTelemetry, 0);
+			}
 
-			int set = 0;
-			bool nextSet = true;
-			int powerUpsTime[NSETS] = {110, 95, 80, 70, 45, 30, 15, 7};
-			int counter = 0;
+			if(netplay && !gNetSession.open(world, netPlayer, localPort, peerHost, remotePort, latency, jitter, loss)) {
+				ERROR_LOG(LOG_NET, "Failed to start network match!");
+				quit = true;
+			}
 
 			//Event handler
 			SDL_Event event;
-			const Uint8* state = SDL_GetKeyboardState(NULL);
 
 			//Set text colour as black
 			SDL_Color textColor = {255, 255, 255, 255};
 
-			//In memory text stream
-			stringstream timeText;
-			stringstream player1Score;
-			stringstream player2Score;
+			//The input for the next tick
+			vector<Uint8> inputs(world.players.size(), 0);
+
+			//Ticks owed to the game logic, in performance counter ticks times TICK_RATE (one tick is frequency)
+			Uint64 frequency = SDL_GetPerformanceFrequency();
+			Uint64 tickBudget = 0;
+			Uint64 lastTime = SDL_GetPerformanceCounter();
+
+			FramePacer pacer(pacing, fps);
+
+			//Frames of play after the first second must not allocate on this thread; only counted in the allocation check build
+			const int ALLOC_WARMUP = TICK_RATE;
+			int steadyFrames = 0, allocFrames = 0;
+			Uint64 steadyAllocations = 0;
 
             //for inputing the text
             gWinnerNameTexture.loadFromRenderedText( winnerName.c_str(), textColor );
@@ -492,918 +424,359 @@ int main(int argc, char *args[]) {
 				//The rerender text flag
                 bool renderText = false;
 
+				Uint64 allocationsBefore = allocationCount();
+				bool steady = false;
+				gFrameArena.reset();
+
 				while(SDL_PollEvent(&event)) {
                     //User requests quit
 					if(event.type == SDL_QUIT) {
 						quit = true;
 					}
-					//Pause/Unpause
-					if(event.type == SDL_KEYDOWN) {
-						if(event.key.keysym.sym == SDLK_RETURN) {
-							gTimer.start();
+					if(world.gameOver) {
+						//Winner name entry
+						if(event.type == SDL_TEXTINPUT) {
+							winnerName += event.text.text;
+							renderText = true;
+						}
+						if(event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_BACKSPACE && winnerName.length() > 0) {
+							winnerName.erase(winnerName.length()-1);
+							renderText = true;
+						}
+					} else if(event.type == SDL_KEYUP) {
+						for(int i = 0; i < gControllers.size(); ++i) {
+							gControllers[i]->keyEvent(event.key.timestamp, event.key.keysym.scancode, false);
+						}
+					} else if(event.type == SDL_KEYDOWN) {
+						//Start and pause are local; a network match starts on its own and can't be paused
+						if(event.key.keysym.sym == SDLK_RETURN && !netplay && !start) {
 							start = true;
 						}
-						if(event.key.keysym.sym == SDLK_p) {
-							if(gTimer.isPaused()) {
-								gTimer.unpause();
-								paused = false;
-							} else {
-								gTimer.pause();
-								paused = true;
-							}
+						//Pause/Unpause; the match clock only moves when the world ticks, so this stops every timer
+						if(event.key.keysym.sym == SDLK_p && !netplay) {
+							paused = !paused;
 						}
 						else if(event.key.repeat == 0) {
-							for(int i = 0; i < gPlayers.size(); ++i) {
-								gPlayers[i].act(event.key.keysym.scancode);
+							for(int i = 0; i < gControllers.size(); ++i) {
+								gControllers[i]->keyEvent(event.key.timestamp, event.key.keysym.scancode, true);
+							}
+							if(measureLatency && start && !paused) {
+								latencyMeter.keyPressed(event.key.timestamp);
 							}
 						}
 					}
 				}
-				
-				for(int i = 0; i < gPlayers.size(); ++i) {gPlayers[i].act(state);}
-
-				//Loads new set of Powerups when nextSet flag is set to true (time dependent)
-				if(nextSet && set < NSETS) {
-					for(int i = 0; i < NPOWERUPS; i++) {
-						for(int j = 0; j < powerUpsSet[set][i]; j++) {
-							gPowerUps.emplace_back(&powerUpsTex[i], i);
-							gEnemies.emplace_back();
+
+				//Replays start right away
+				if(!start && replayPath != NULL) {
+					start = true;
+				}
+
+				if(netplay) {
+					gNetSession.receive();
+					if(!start && gNetSession.connected) {
+						start = true;
+					}
+				}
+
+				//Run the game logic at a fixed rate, no matter how fast frames are drawn
+				Uint64 now = SDL_GetPerformanceCounter();
+				Uint32 nowTicks = SDL_GetTicks();
+				if(start && !paused && !world.gameOver) {
+					tickBudget += (now-lastTime)*TICK_RATE;
+					//Don't try to catch up after a long hitch
+					if(tickBudget > 5*frequency) {tickBudget = 5*frequency;}
+
+					while(tickBudget >= frequency && !world.gameOver) {
+						tickBudget -= frequency;
+
+						//The budget left over is time not simulated yet, so this tick ends that long before now
+						Uint32 tickEnd = nowTicks-(Uint32) (tickBudget*1000/(frequency*TICK_RATE));
+						for(int i = 0; i < gControllers.size(); ++i) {
+							gControllers[i]->setTickEnd(tickEnd);
+						}
+						if(measureLatency) {
+							latencyMeter.tickRan(tickEnd);
+						}
+
+						if(netplay) {
+							gNetSession.advance(gControllers[netPlayer]->next(world, netPlayer));
+						} else {
+							for(int i = 0; i < world.players.size(); ++i) {
+								inputs[i] = gControllers[i]->next(world, i);
+							}
+							if(recordFile != NULL) {
+								fwrite(inputs.data(), 1, inputs.size(), recordFile);
+							}
+							world.tick(inputs.data());
 						}
 					}
-					nextSet = false;
 				}
+				float frameSeconds = (float) (now-lastTime)/frequency;
+				lastTime = now;
+
+				if(netplay) {
+					gNetSession.send();
+				}
+
 				if(!start) {
 					SDL_RenderClear(gRenderer);
 					gMainTexture.render(0,0);
 				} else if(paused) {
 					SDL_RenderClear(gRenderer);
 					gPauseTexture.render(0,0);
-					disableCon = true;
-				} else if(gameOver) {
-					gLevel = 0;
+					world.disableCon = true;
+				} else if(world.gameOver) {
+					world.level = 0;
                     SDL_RenderClear(gRenderer);
-                    bool inputPlayerOne = false;
                     //Enable text input
                     SDL_StartTextInput();
-                     while(SDL_PollEvent(&event)) {
-                        if(event.type == SDL_QUIT) {
-                            quit = true;
-					    }
-                        if(event.type == SDL_TEXTINPUT) {
-                            winnerName += event.text.text;
-                            renderText = true;
-                        }
-                        if( event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_BACKSPACE) {
-                            winnerName.erase(winnerName.length()-1);
-                            renderText = true;
-                        }
-                    }
-					
-					if(gPlayers[0].score > gPlayers[1].score) {
-						winnerScore = gPlayers[0].score;
-						gPlayerOneWins.render(0,0);
 
-						if( renderText==true ) {
-                            //Text is not empty
-                            if( winnerName != "" ) {
-                                //Render new text
-                                gWinnerNameTexture.loadFromRenderedText( winnerName.c_str(), textColor );
-                            }
-                        }
-                        gWinnerNameTexture.render( 400, 400);
-
-					} else if(gPlayers[1].score > gPlayers[0].score) {
-						winnerScore = gPlayers[1].score;
+					int winner = max(world.leader(&Player::score), 0);
+					winnerScore = world.players[winner].score;
+					if(winner == 0) {
+						gPlayerOneWins.render(0,0);
+					} else if(winner == 1) {
 						gPlayerTwoWins.render(0,0);
-
-                        if( renderText==true ) {
-                            //Text is not empty
-                            if( winnerName != "" ) {
-                                //Render new text
-                                gWinnerNameTexture.loadFromRenderedText( winnerName.c_str(), textColor );
-                            }
-                        }
-                        gWinnerNameTexture.render( 400, 400);
-                    } else if(gPlayers[1].score == gPlayers[0].score) { //tie
-                        SDL_RenderClear(gRenderer);
-                        gameOver = false;
-                        gTimer.start();
-                        restart();
-                    }
-				} else if(reset) {
-					SDL_RenderClear(gRenderer);
-					if(gPlayers[0].life > gPlayers[1].life) {
-						gPlayers[0].score++;
-						restart();
-					} else if(gPlayers[1].life > gPlayers[0].life) {
-						gPlayers[1].score++;
-						restart();
-					}
-				} else if(!reset) {
-                    disableCon = false;
-					//Viewports
-					SDL_Rect scoreboard = {0, 0, SCREEN_WIDTH, SCOREBOARD_HEIGHT};
-					SDL_Rect playfield = {0, SCOREBOARD_HEIGHT, SCREEN_WIDTH, PLAYFIELD_HEIGHT};
-
-					SDL_RenderClear(gRenderer);
-					SDL_RenderSetViewport(gRenderer, &scoreboard);
-
-					SDL_SetRenderDrawColor(gRenderer, 0x00, 0x80, 0x80, 0xFF);
-					SDL_RenderFillRect(gRenderer, &scoreboard);
-
-					//Set text to be rendered
-					timeText.str("");
-					timeText << "Time: " << levelDuration - gTimer.getTicks()/1000;
-                    player1Score.str("");
-                    player1Score<<"Player 1: "<<gPlayers[0].score;
-                    player2Score.str("");
-                    player2Score<<"Player 2: "<<gPlayers[1].score;
-					//Render text
-					if(!gTimeTextTexture.loadFromRenderedText(timeText.str().c_str(), textColor)) {
-						printf("Unable to render time texture!\n");
-					}
-					if(!gPlayer1ScoreTexture.loadFromRenderedText(player1Score.str().c_str(), textColor)) {
-						printf("Unable to render player1score texture!\n");
-					}
-					if(!gPlayer2ScoreTexture.loadFromRenderedText(player2Score.str().c_str(), textColor)) {
-						printf("Unable to render player2score texture!\n");
+					} else {
+						if(gPlayerWinsShown != winner) {
+							string text = "Player "+to_string(winner+1)+" wins!";
+							gPlayerWinsTexture.loadFromRenderedText(text.c_str(), textColor);
+							gPlayerWinsShown = winner;
+						}
+						gPlayerWinsTexture.render((SCREEN_WIDTH-gPlayerWinsTexture.getWidth())/2, 200);
 					}
 
-					gTimeTextTexture.render((SCREEN_WIDTH-gTimeTextTexture.getWidth())/2, (SCOREBOARD_HEIGHT-gTimeTextTexture.getLength())/2);
-					gPlayer1ScoreTexture.render((SCREEN_WIDTH-gPlayer1ScoreTexture.getWidth())/2-300, (SCOREBOARD_HEIGHT-gPlayer1ScoreTexture.getLength())/2);
-					gPlayer2ScoreTexture.render((SCREEN_WIDTH-gPlayer2ScoreTexture.getWidth())/2+250, (SCOREBOARD_HEIGHT-gPlayer2ScoreTexture.getLength())/2);
-					gPlayerOneTexture.render(30, 15);
-					gPlayerTwoTexture.render(SCREEN_WIDTH-SCREEN_WIDTH/6-30, 15);
-
-					for(int i = 0; i < gPlayers.size(); i++) {
-						gPlayers[i].renderLifeTexture();
-						if(gPlayers[i].life <= 0) {
-							reset = true;
+					if( renderText==true ) {
+						//Text is not empty
+						if( winnerName != "" ) {
+							//Render new text
+							gWinnerNameTexture.loadFromRenderedText( winnerName.c_str(), textColor );
 						}
 					}
-					
-					if((levelDuration - gTimer.getTicks()/1000) == 0) {gameOver = true;}
-
-					SDL_RenderSetViewport(gRenderer, &playfield);
-					
-					gLevels[gLevel].render(frame);
-
-					for(int i = 0; i < gEnemyBullets.size(); ++i) {
-                        if(gEnemyBullets[i].move(gTimer.getTicks())||gEnemyBullets[i].blanks()) {
-                            gEnemyBullets[i].render();
-                        } else {
-                            gEnemyBullets.erase(gEnemyBullets.begin()+i);
-                        }
-                    }
-
-					if((levelDuration - gTimer.getTicks()/1000) < powerUpsTime[set] && set < NSETS) {
-						for(int i = 0; i < gPowerUps.size(); i++) {
-							gPowerUps[i].render();
-							gEnemies[i].move(gTimer.getTicks());
-							gEnemies[i].render();
-							if(!gDsplyPwrUpsTimer.isStarted()) {
-								gDsplyPwrUpsTimer.start();
-							}
-							if(gDsplyPwrUpsTimer.getTicks()/1000 > DSPLYTIMEPWRUP) {
-								gPowerUps.clear();
-								gEnemies.clear();
-								gDsplyPwrUpsTimer.stop();
-								nextSet = true;
-								set++;
-								printf("Powerups cleared\n");
-							}
-						}
+					gWinnerNameTexture.render( 400, 400);
+				} else {
+                    world.disableCon = false;
+					steady = world.frame >= ALLOC_WARMUP;
+					gParticles.update(frameSeconds);
+					renderGame(world);
+					if(gCapture.isOpen() && world.frame != capturedTick) {
+						gCapture.capture();
+						capturedTick = world.frame;
 					}
+				}
+				pacer.wait();
+				SDL_RenderPresent(gRenderer);
+				pacer.presented();
+				if(measureLatency) {
+					latencyMeter.presented(SDL_GetTicks());
+				}
 
-					for(int i = 0; i < gBullets.size(); ++i) {
-                        if(gBullets[i].move()||gBullets[i].blanks()) {
-                            gBullets[i].render();
-                        }
-                        else {
-                            gBullets.erase(gBullets.begin()+i);
-                        }
-                    }
-
-                    for(int i = 0; i<gBomb.size(); i++) {
-                        if(gBomb[i].timer.getTicks()/1000 > Bomb::TIMER) {
-                            gBomb[i].blowUp(gBomb[i].bombPosX, gBomb[i].bombPosY);
-                            gBomb[i].renderExplosion();
-                            gBomb.erase(gBomb.begin()+i);
-                        }
-                        else {
-                        	gBomb[i].render();
-                        }
-                    }
-
-                    for(int i = 0; i < gPlayers.size(); i++) {
-						gPlayers[i].render();
-						if(gPlayers[i].shieldEnable == true && gPlayers[i].shieldTimer.getTicks()/1000>Player::SHIELD_DURATION) {
-                            gPlayers[i].shieldEnable = false;
-                            gPlayers[i].shieldTimer.stop();
-                        }
-                        if(gPlayers[i].bombEnable == true && gPlayers[i].bombTimer.getTicks()/1000>Player::BOMB_DURATION) {
-                            gPlayers[i].bombEnable = false;
-                            gPlayers[i].bombTimer.stop();
-                        }
-						for(int j = 0; j < gPowerUps.size(); j++) {
-							if(checkCollision(gPlayers[i].getCollider(), gPowerUps[j].getCollider())) {
-                                gPlayers[i].activatePowerUp(gPowerUps[j].getPowerUpID(),gPowerUps[j].powerUpRect);
-                                gPowerUps.erase(gPowerUps.begin()+j);
-						    }
-						}
+				if(steady) {
+					++steadyFrames;
+					Uint64 allocations = allocationCount()-allocationsBefore;
+					if(allocations > 0) {
+						if(allocFrames == 0) {ERROR_LOG(LOG_SYSTEM, "Frame at tick %d allocated %d times", world.frame, (int) allocations);}
+						++allocFrames;
+						steadyAllocations += allocations;
 					}
+				}
+			}
 
-                    if(gPlayers[0].shieldEnable == true) {gPlayerOneTexture.loadFromFile("Assets/p1_shield.png");}
-                    else {gPlayerOneTexture.loadFromFile("Assets/p1.png");}
+			#ifdef ALLOC_CHECK
+			printf("Allocation check: %d of %d frames of play allocated (%llu allocations)\n", allocFrames, steadyFrames, (unsigned long long) steadyAllocations);
+			allocFailed = allocFrames > 0;
+			#endif
 
-                    if(gPlayers[1].shieldEnable == true) {gPlayerTwoTexture.loadFromFile("Assets/p2_shield.png");}
-                    else {gPlayerTwoTexture.loadFromFile("Assets/p2.png");}
-				}
-				SDL_RenderPresent(gRenderer);
-				
-				++frame;
+			if(measureLatency) {
+				latencyMeter.report();
+			}
+			if(frameStats) {
+				pacer.report();
+			}
+			if(renderStats) {
+				gRenderQueue.report();
+			}
+			gCapture.close();
+			gTelemetry.close();
+
+			//Enemy bullets are bounded by the field; a refused shot means the pool is too small for the waves
+			if(world.frame > 0) {
+				LOG_AT(world.enemyBulletsRefused > 0 ? LOG_LEVEL_WARN : LOG_LEVEL_INFO, LOG_GAME, "Enemy bullets: peak %d live, mean %.1f, %d shots refused",
+					world.enemyBulletPeak, (double) world.enemyBulletTicks/world.frame, world.enemyBulletsRefused);
+			}
+
+			if(netplay) {
+				INFO_LOG(LOG_NET, "Netplay: %d rollbacks, %d ticks re-simulated, %d stalls", gNetSession.rollbacks, gNetSession.resimulatedTicks, gNetSession.stalls);
+				gNetSession.close();
 			}
+			if(recordFile != NULL) {
+				fclose(recordFile);
+			}
+			for(int i = 0; i < gControllers.size(); ++i) {
+				delete gControllers[i];
+			}
+			gControllers.clear();
 		}
     }
 	close();
 	SDL_StopTextInput();
     recordScore();
-    return 0;
-}
-
-LTexture::LTexture() {
-	//Initialize
-	mTexture = NULL;
-	mWidth = 0;
-	mLength = 0;
-}
-
-LTexture::~LTexture() {
-	//Deallocate
-	free();
-}
-
-bool LTexture::loadFromFile(string path) {
-	//Get rid of preexisting texture
-	free();
-
-	//The final texture
-	SDL_Texture* newTexture = NULL;
-
-	//Load image at specified path
-	SDL_Surface* loadedSurface = IMG_Load(path.c_str());
-
-	if(loadedSurface == NULL) {
-		printf("Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
-	} else {
-		//Color key image
-		SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, 0xFF, 0xFF, 0xFF));
-
-		//Create texture from surface pixels
-		newTexture = SDL_CreateTextureFromSurface(gRenderer, loadedSurface);
-
-		if(newTexture == NULL) {
-			printf("Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
-		} else {
-			//Get image dimensions
-			mWidth = loadedSurface->w;
-			mLength = loadedSurface->h;
-		}
-
-		//Get rid of loaded surface
-		SDL_FreeSurface(loadedSurface);
-	}
-
-	//Return success
-	mTexture = newTexture;
-	return mTexture != NULL;
-}
-
-#ifdef _SDL_TTF_H
-bool LTexture::loadFromRenderedText(string textureText, SDL_Color textColor) {
-	//Get rid of preexisting texture
-	free();
-
-	//Render text surface
-	SDL_Surface* textSurface = TTF_RenderText_Solid(gFont, textureText.c_str(), textColor);
-	if(textSurface == NULL) {
-		printf("Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError());
-	} else {
-		//Create texture from surface pixels
-		mTexture = SDL_CreateTextureFromSurface(gRenderer, textSurface);
-		if(mTexture == NULL) {
-			printf("Unable to create texture from rendered text! SDL Error: %s\n", SDL_GetError());
-		} else {
-			//Get image dimensions
-			mWidth = textSurface->w;
-			mLength = textSurface->h;
-		}
-		SDL_FreeSurface(textSurface);
-	}
-	return mTexture != NULL;
-}
-#endif
-
-void LTexture::free() {
-	//Free texture if it exists
-	if(mTexture != NULL) {
-		SDL_DestroyTexture(mTexture);
-		mTexture = NULL;
-		mWidth = 0;
-		mLength = 0;
-	}
-}
-
-void LTexture::setColor(Uint8 red, Uint8 green, Uint8 blue) {
-	//Modulate texture
-	SDL_SetTextureColorMod(mTexture, red, green, blue);
-}
-
-void LTexture::setBlendMode(SDL_BlendMode blending) {
-	//Set blending function
-	SDL_SetTextureBlendMode(mTexture, blending);
-}
-
-void LTexture::setAlpha(Uint8 alpha) {
-	//Modulate texture alpha
-	SDL_SetTextureAlphaMod(mTexture, alpha);
-}
-
-void LTexture::render(SDL_Rect* dst, SDL_Rect* src, double angle, SDL_Point* center, SDL_RendererFlip flip) {
-	//Set clip rendering dimensions
-	if(dst->w == 0 || dst->h == 0) {
-		dst->w = mWidth;
-		dst->h = mLength;
-	}
-	//Render to screen
-	SDL_RenderCopyEx(gRenderer, mTexture, src, dst, angle, center, flip);
-}
-
-void LTexture::render(int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip) {
-	//Set rendering space and render to screen
-	SDL_Rect renderQuad = {x, y, mWidth, mLength};
-
-	//Set clip rendering dimensions
-	if(clip != NULL) {
-		renderQuad.w = clip->w;
-		renderQuad.h = clip->h;
-	}
-	//Render to screen
-	SDL_RenderCopyEx(gRenderer, mTexture, clip, &renderQuad, angle, center, flip);
-}
-
-int LTexture::getWidth() {
-	return mWidth;
-}
-
-int LTexture::getLength() {
-	return mLength;
-}
-
-LTimer::LTimer() {
-	//Initialize the variables
-	mStartTicks = 0;
-	mPausedTicks = 0;
-	mPaused = false;
-	mStarted = false;
-}
-
-void LTimer::start() {
-	//Start the timer
-	mStarted = true;
-	//Unpause the timer
-	mPaused = false;
-	//Get the current clock time
-	mStartTicks = SDL_GetTicks();
-	mPausedTicks = 0;
-}
-
-void LTimer::stop() {
-	//Stop the timer
-	mStarted = false;
-
-	//Unpause the timer
-	mPaused = false;
-
-	//Clear tick variables
-	mStartTicks = 0;
-	mPausedTicks = 0;
-}
-
-void LTimer::pause() {
-	//If the timer is running and isn't already paused
-	if(mStarted && !mPaused) {
-		//Pause the timer
-		mPaused = true;
-		//Calculate the paused ticks
-		mPausedTicks = SDL_GetTicks()-mStartTicks;
-		mStartTicks = 0;
-	}
-}
-
-void LTimer::unpause() {
-	//If the timer is running and paused
-	if(mStarted && mPaused) {
-		//Unpause the timer
-		mPaused = false;
-
-		//Reset the startng ticks
-		mStartTicks = SDL_GetTicks()-mPausedTicks;
-
-		//Reset the paused ticks
-		mPausedTicks = 0;
-	}
-}
-
-Uint32 LTimer::getTicks() {
-	//The actual timer time
-	Uint32 time = 0;
-	//If the timer is running
-	if(mStarted) {
-		//If the timer is paused
-		if(mPaused) {
-			//Return the number of ticks when the timer is paused
-			time = mPausedTicks;
-		} else {
-			//Return the current time minus the start time
-			time = SDL_GetTicks()-mStartTicks;
-		}
-	}
-	return time;
-}
-
-bool LTimer::isStarted() {
-	//Timer is running and paused or unpaused
-	return mStarted;
-}
-
-bool LTimer::isPaused() {
-	//Timer is running and paused
-	return mPaused && mStarted;
-}
-
-int Tile::getTileType() {
-	return tileType;
-}
-
-int Tile::getWalkability() {
-	return walkability;
-}
-
-int Tile::getDirection() {
-	return direction;
-}
-
-void Tile::render(int frame, SDL_Rect renderDst) {
-	gSpriteSheet.render(&renderDst, &renderSrc[frame/2%renderSrc.size()], direction*90);
+	gLogger.close();
+    return allocFailed ? 1 : 0;
 }
 
-Map::Map() {
-	if(mapReader.is_open()) {
-		string mapName;
-		
-		if(!mapReader.eof()) {
-			while(mapReader.get() != '[') {}
-			getline(mapReader, mapName, ']');
-		}
-		
-		for(int i = 0; i < Map::ROWS; ++i) {
-			for(int j = 0; j < Map::COLS; ++j) {
-				int tileType;
-				if(!mapReader.eof()) {
-					mapReader >> tileType;
-					if(tileType < 0 || tileType >= TOTAL_TILES) {tileType = 0;}
-				} else {
-					tileType = 0;
-				}
-				tileMap[j][i] = gTiles[tileType];
-			}
-		}
-	}
-	
-	t.w = Tile::WIDTH;
-	t.h = Tile::HEIGHT;
+Score::Score(string playerName, int playerScore) {
+    name = playerName;
+    score = playerScore;
 }
 
-Tile* Map::tile(int x, int y) {
-	if(x >= 0 && x < Tile::WIDTH*Map::COLS
-		&& y >= 0 && y < Tile::HEIGHT*Map::ROWS) {
-		return tileMap[x/Tile::WIDTH][y/Tile::HEIGHT];
-	} else {
-		return gTiles[STEEL];
-	}
+LatencyMeter::LatencyMeter():
+	pendingCount(0), appliedCount(0), samples(0), total(0), worst(0) {
+	memset(histogram, 0, sizeof(histogram));
 }
 
-void Map::hit(int x, int y) {
-	if(tile(x, y) == gTiles[BRICK]) {
-		tileMap[x/Tile::WIDTH][y/Tile::HEIGHT] = gTiles[GRASS];
+void LatencyMeter::keyPressed(Uint32 timestamp) {
+	if(pendingCount < MAX_PENDING) {
+		pending[pendingCount++] = timestamp;
 	}
 }
 
-void Map::render(int frame) {
-	for(int i = 0; i < ROWS; ++i) {
-		for(int j = 0; j < COLS; ++j) {
-			t.x = j*Tile::WIDTH;
-			t.y = i*Tile::HEIGHT;
-			
-			tileMap[j][i]->render(frame, t);
-		}
+void LatencyMeter::tickRan(Uint32 tickEnd) {
+	//Same rule as KeyboardController: a press belongs to the first tick ending at or after it
+	int applying = 0;
+	while(applying < pendingCount && (Sint32) (pending[applying]-tickEnd) <= 0 && appliedCount < MAX_PENDING) {
+		applied[appliedCount++] = pending[applying++];
 	}
+	pendingCount -= applying;
+	memmove(pending, pending+applying, pendingCount*sizeof(Uint32));
 }
 
-void Player::act(const Uint8* state) {
-    if(!disableCon) {
-		if(state[con[UP]]) {move(0, -vel); dir = NORTH;}
-		if(state[con[LEFT]]) {move(-vel, 0); dir = WEST;}
-		if(state[con[DOWN]]) {move(0, vel); dir = SOUTH;}
-		if(state[con[RIGHT]]) {move(vel, 0); dir = EAST;}
+void LatencyMeter::presented(Uint32 time) {
+	for(int i = 0; i < appliedCount; ++i) {
+		Uint32 latency = time-applied[i];
+		++histogram[min(latency, (Uint32) BUCKETS-1)];
+		total += latency;
+		worst = max(worst, latency);
+		++samples;
 	}
-
-	react();
+	appliedCount = 0;
 }
 
-void Player::act(SDL_Scancode key) {
-	if(!disableCon) {
-		if(key == con[SHOOT]) {shoot();}
-		if(key == con[PLACEBOMB] && bombEnable) {placeBomb();}
+void LatencyMeter::report() {
+	if(samples == 0) {
+		printf("Input latency: no key presses measured\n");
+		return;
 	}
-}
-
-void Player::react() {
-	SDL_Rect tileBoxOfOrigin = {playerRect.x-playerRect.x%Tile::WIDTH, playerRect.y-playerRect.y%Tile::HEIGHT, Tile::WIDTH, Tile::HEIGHT};
-	
-	if(gLevels[gLevel].tile(playerRect.x, playerRect.y)->getTileType() >= SLIDE_DOWN
-	&& gLevels[gLevel].tile(playerRect.x, playerRect.y)->getTileType() <= SLIDE_RIGHT
-	&& (checkIfEnclosed(playerRect, tileBoxOfOrigin) || wasPreviouslyOnSlidewalk)) {
-		if(checkIfEnclosed(playerRect, tileBoxOfOrigin)) {
-			lastEnteredSlidewalk = tileBoxOfOrigin;
+	//Smallest latency that the given share of presses stayed under
+	int percentiles[3] = {50, 95, 99};
+	int values[3];
+	for(int p = 0; p < 3; ++p) {
+		int needed = (samples*percentiles[p]+99)/100, seen = 0, ms = 0;
+		while(ms < BUCKETS-1 && seen+histogram[ms] < needed) {
+			seen += histogram[ms++];
 		}
-		dir = (gLevels[gLevel].tile(lastEnteredSlidewalk.x, lastEnteredSlidewalk.y)->getDirection()+1)%4;
-		wasPreviouslyOnSlidewalk = true;
-		
-		switch(dir) {
-			case SOUTH: move(0, vel); break;
-			case WEST: move(-vel, 0); break;
-			case NORTH: move(0, -vel); break;
-			case EAST: move(vel, 0); break;
-		}
-	} else if(checkIfEnclosed(playerRect, tileBoxOfOrigin)) {
-		wasPreviouslyOnSlidewalk = false;
+		values[p] = ms;
 	}
+	printf("Input latency over %d presses: mean %.1f ms, median %d ms, 95%% %d ms, 99%% %d ms, max %u ms\n",
+		samples, (double) total/samples, values[0], values[1], values[2], worst);
 }
 
-void Player::move(int vx, int vy) {
-    playerRect.x += vx;//whatever the position of the rectangle is will also be the position where the rectangel will be rendered
-    shiftColliders();
-
-    if((gLevels[gLevel].tile(playerRect.x, playerRect.y))->getWalkability() > 0
-	|| (gLevels[gLevel].tile(playerRect.x+WIDTH, playerRect.y))->getWalkability() > 0
-	|| (gLevels[gLevel].tile(playerRect.x, playerRect.y+HEIGHT))->getWalkability() > 0
-	|| (gLevels[gLevel].tile(playerRect.x+WIDTH, playerRect.y+HEIGHT))->getWalkability() > 0
-	|| (checkCollision(gPlayers[0].getCollider(), gPlayers[1].getCollider())) 
-	|| (checkBombCollide(collider))
-	|| (checkEnemyCollide(collider, &life, collisionReady))
-	) {
-		playerRect.x -= vx;
-		shiftColliders();
-    }
-    
-	playerRect.y += vy;//whatever the position of the rectangle is will also be the position where the rectangel will be rendered
-    shiftColliders();
-
-    if((gLevels[gLevel].tile(playerRect.x, playerRect.y))->getWalkability() > 0
-	|| (gLevels[gLevel].tile(playerRect.x+WIDTH, playerRect.y))->getWalkability() > 0
-	|| (gLevels[gLevel].tile(playerRect.x, playerRect.y+HEIGHT))->getWalkability() > 0
-	|| (gLevels[gLevel].tile(playerRect.x+WIDTH, playerRect.y+HEIGHT))->getWalkability() > 0
-	|| (checkCollision(gPlayers[0].getCollider(), gPlayers[1].getCollider())) 
-	|| (checkBombCollide(collider))
-	|| (checkEnemyCollide(collider, &life, collisionReady))
-	) {
-		playerRect.y -= vy;
-		shiftColliders();
-    }
+FramePacer::FramePacer(int pacingMode, int fps):
+	mode(pacingMode), frequency(SDL_GetPerformanceFrequency()), frames(0), sum(0), sumSquares(0), shortest(0), longest(0) {
+	period = frequency/fps;
+	deadline = SDL_GetPerformanceCounter()+period;
+	lastPresent = 0;
 }
 
-Circle& Player::getCollider() {
-	return collider;
-}
-
-void Player::shiftColliders() {
-	collider.x = playerRect.x+collider.r;
-	collider.y = playerRect.y+collider.r;
-}
-
-void Player::shoot() {
-   if(bulletUpEnable == false) {
-        if(dir == EAST) gBullets.emplace_back((playerRect.x+WIDTH), (playerRect.y+HEIGHT/2), dir);
-        else if(dir == WEST) gBullets.emplace_back((playerRect.x-WIDTH/4), (playerRect.y+HEIGHT/2), dir);
-        else if(dir == SOUTH) gBullets.emplace_back((playerRect.x+WIDTH/2), (playerRect.y+HEIGHT), dir);
-        else if(dir == NORTH) gBullets.emplace_back((playerRect.x+WIDTH/2), (playerRect.y-HEIGHT/4), dir);
-    }
-    else if(bulletUpEnable == true) {
-        gBullets.emplace_back((playerRect.x+WIDTH), (playerRect.y+HEIGHT/2), EAST);
-        gBullets.emplace_back((playerRect.x-WIDTH), (playerRect.y+HEIGHT/2), WEST);
-        gBullets.emplace_back((playerRect.x+WIDTH/2), (playerRect.y+HEIGHT), SOUTH);
-        gBullets.emplace_back((playerRect.x+WIDTH/2), (playerRect.y-HEIGHT), NORTH);
-    }
-}
+void FramePacer::wait() {
+	if(mode != LIMITED) {return;}
 
-void Player::placeBomb() {
-    gBomb.emplace_back(playerRect.x, playerRect.y);
-}
-
-void Player::render() {
-     playerTex->render(&playerRect, NULL, 90*dir);
-}
-
-void Player::renderLifeTexture() {
-	for(int i = 0; i < life; i++) {
-		gLifeAvailableTexture.render(lifeXPos+(gLifeAvailableTexture.getWidth()*i), 15);
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint64 spin = frequency*SPIN_MICROSECONDS/1000000;
+	//Sleep through most of the wait, then spin to the deadline
+	if(now+spin < deadline) {
+		SDL_Delay((Uint32) ((deadline-now-spin)*1000/frequency));
 	}
-}
-
-void Player::activatePowerUp(int id, SDL_Rect& Rect) {
-	switch(id) {
-		case LIFE:
-			printf("life\n");
-			if(life <= 7)life++;
-			break;
-		case BOMB:
-            printf("bomb\n");
-            bombTimer.start();
-            bombEnable = true;
-            break;
-		case SHIELD:
-			printf("shield\n");
-			shieldTimer.start();
-			shieldEnable = true;
-			break;
-		case BULLETUPGRADE:
-			printf("bullet upgraded\n");
-            bulletUpEnable = true;
-			break;
-		case SPEEDUP:
-			printf("speedup\n");
-            vel++;
-			break;
+	while((now = SDL_GetPerformanceCounter()) < deadline) {}
+
+	//Fell more than a frame behind: start over from now rather than rushing frames out to catch up
+	deadline += period;
+	if(now > deadline) {deadline = now+period;}
+}
+
+void FramePacer::presented() {
+	Uint64 now = SDL_GetPerformanceCounter();
+	if(lastPresent != 0) {
+		double ms = (now-lastPresent)*1000.0/frequency;
+		if(frames == 0 || ms < shortest) {shortest = ms;}
+		if(frames == 0 || ms > longest) {longest = ms;}
+		sum += ms;
+		sumSquares += ms*ms;
+		++frames;
 	}
+	lastPresent = now;
 }
 
-PowerUp::PowerUp(LTexture* texture, int pwrUp_id) {
-	//gets a random position to place the powerup
-	int randInd = type()%xTile.size();
-	powerUpRect = {xTile[randInd]+Tile::WIDTH/5, yTile[randInd]+Tile::HEIGHT/5, texture->getWidth(), texture->getLength()};
-	powerUpTex = texture;
-	id = pwrUp_id;
-	collider = {xTile[randInd]+Tile::WIDTH/5+WIDTH/2, yTile[randInd]+Tile::HEIGHT/5+WIDTH/2, WIDTH/2};
-}
-
-void PowerUp::render() {
-	powerUpTex->render(&powerUpRect);
-}
-
-int PowerUp::getPowerUpID() {
-	return id;
-}
-
-Circle& PowerUp::getCollider() {
-    return collider;
-}
-
-bool Bullet::move() {
-	x += VEL*cos(PI*(dir+1)/2);
-	y += VEL*sin(PI*(dir+1)/2);
-
-	SDL_Rect bullet{(int) x, (int) y, WIDTH, HEIGHT};
-
-    if(gLevels[gLevel].tile(x, y) == gTiles[BRICK]) {
-        gLevels[gLevel].hit(x, y);
-        return false;
-    }
-    else if(gLevels[gLevel].tile(x+WIDTH, y+HEIGHT) == gTiles[BRICK]) {
-        gLevels[gLevel].hit(x+WIDTH, y+HEIGHT);
-        return false;
-    }
-    else if(gLevels[gLevel].tile(x, y) == gTiles[STEEL]) {
-        return false;
-    }
-    else if(checkCollision(gPlayers[0].getCollider(), bullet)) {
-        gPlayers[0].life--;
-        return false;
-    }
-    else if(checkCollision(gPlayers[1].getCollider(), bullet)) {
-        gPlayers[1].life--;
-        return false;
-    }
-	return true;
-}
-
-bool Bullet::move(Uint32 t) {
-	x += VEL*cos(dir%4*PI/2);
-	y += VEL*sin(dir%4*PI/2);
-	SDL_Rect bullet{(int) x, (int) y, WIDTH, HEIGHT};
-	if(checkCollision(gPlayers[0].getCollider(), bullet)) {
-        gPlayers[0].life--;
-        return false;
-    }
-    if(checkCollision(gPlayers[1].getCollider(), bullet)) {
-        gPlayers[1].life--;
-        return false;
-    }
-    return true;
-}
-
-void Bullet::render() {
-	SDL_Rect bullet{(int) x, (int) y, WIDTH, HEIGHT};
-	SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 0xFF);
-	SDL_RenderFillRect(gRenderer, &bullet);
-}
-
-bool Bullet::blanks() {
-    SDL_Rect bullet{(int) x, (int) y, WIDTH, HEIGHT};
-    if(checkCollision(gPlayers[0].getCollider(), bullet)&&gPlayers[0].shieldEnable == true) {
-        gPlayers[0].life++;
-        return false;
-    }
-    if(checkCollision(gPlayers[1].getCollider(), bullet)&&gPlayers[1].shieldEnable == true) {
-        gPlayers[1].life++;
-        return false;
-    }
-}
-
-Circle& Bomb::getCollider() {
-	return collider;
-}
-
-void Bomb::render() {
-    gBombTexture.render(bombPosX+Player::WIDTH-(bombPosX+Player::WIDTH)%Tile::WIDTH+Tile::WIDTH/2-gBombTexture.getWidth()/2,
-        bombPosY+Player::HEIGHT-(bombPosY+Player::HEIGHT)%Tile::HEIGHT+Tile::HEIGHT/2-gBombTexture.getLength()/2);
-}
-
-void Bomb::renderExplosion() {
-    gExplosionTexture.render(bombPosX+Player::WIDTH-(bombPosX+Player::WIDTH)%Tile::WIDTH+Tile::WIDTH/2-gExplosionTexture.getWidth()/2,
-        bombPosY+Player::HEIGHT-(bombPosY+Player::HEIGHT)%Tile::HEIGHT+Tile::HEIGHT/2-gExplosionTexture.getLength()/2);
-}
-
-void Bomb::blowUp(int x, int y) {
-    for(int i = 1; i<=scope; i++) {
-        if(gLevels[gLevel].tile((x+Tile::WIDTH*i), y) == gTiles[BRICK]) {
-            gLevels[gLevel].tileMap[(x+Tile::WIDTH*i)/Tile::WIDTH][y/Tile::HEIGHT]=gTiles[GRASS];//right
-        }
-        if(gLevels[gLevel].tile((x-Tile::WIDTH*i), y) == gTiles[BRICK]) {
-            gLevels[gLevel].tileMap[(x-Tile::WIDTH*i)/Tile::WIDTH][y/Tile::HEIGHT]=gTiles[GRASS];//left
-        }
-        if(gLevels[gLevel].tile((x), (y-Tile::HEIGHT*i)) == gTiles[BRICK]) {
-            gLevels[gLevel].tileMap[(x)/Tile::WIDTH][(y-Tile::HEIGHT*i)/Tile::HEIGHT]=gTiles[GRASS];//up
-        }
-        if(gLevels[gLevel].tile((x), (y+Tile::HEIGHT*i)) == gTiles[BRICK]) {
-            gLevels[gLevel].tileMap[(x)/Tile::WIDTH][(y+Tile::HEIGHT*i)/Tile::HEIGHT]=gTiles[GRASS];//down
-        }
-    }
-    for(int i = 0; i < gPlayers.size(); i++) {
-    	if( (gPlayers[i].playerRect.x < x && gPlayers[i].playerRect.x > x-Tile::WIDTH*scope && (gPlayers[i].playerRect.y > y || gPlayers[i].playerRect.y < y+Tile::HEIGHT*scope)) //player on the left
-    		|| (gPlayers[i].playerRect.x > x + Tile::WIDTH && gPlayers[i].playerRect.x < x+Tile::WIDTH + (Tile::WIDTH*scope) && (gPlayers[i].playerRect.y > y || gPlayers[i].playerRect.y < y+Tile::HEIGHT*scope)) //player on the right
-    		|| (gPlayers[i].playerRect.y < y && gPlayers[i].playerRect.y > y-Tile::WIDTH*scope && (gPlayers[i].playerRect.x > x || gPlayers[i].playerRect.x < x+Tile::WIDTH*scope))//player on top
-    		|| (gPlayers[i].playerRect.y > y + Tile::HEIGHT && gPlayers[i].playerRect.y < y+Tile::HEIGHT+(Tile::HEIGHT*scope) && (gPlayers[i].playerRect.x > x || gPlayers[i].playerRect.x < x+Tile::WIDTH*scope))//player on bottom
-    		|| checkBombCollide(gPlayers[i].getCollider())//player on bomb
-    		) {
-    		gPlayers[i].life--;
-    	}
-    }
-}
-
-Enemy::Enemy() {
-	int randInd = type()%xTile.size();
-	posX = xTile[randInd] + WIDTH/2;
-	posY = yTile[randInd] + HEIGHT/2;
-
-	//random path
-	path = type()%3;
-	if(type()%2 == 1){initDir = true;}
-	else{initDir = false;}
-
-	//random velocities
-	vx = type()%2-1;
-	vy = type()%2-1;
-	if(vx==0||vy==0) {vx = 1; vy = 1;}
-
-	angle = 0;
-	collider = {posX, posY, WIDTH/2};
-	collisionReady = true;
-}
-
-void Enemy::shoot() {
-	gEnemyBullets.emplace_back(posX+WIDTH/2-1, posY+HEIGHT/2-1, angle);
-}
-
-void Enemy::move(Uint32 t) {
-	switch(path) {
-		//Linear movement
-		case 0:
-			posX+=vx;
-			if(posX < 0 || posX+WIDTH > SCREEN_WIDTH ) {vx = -1*vx;}
-			posY+=vy;
-			if(posY < 0 || posY+HEIGHT > SCREEN_HEIGHT-SCOREBOARD_HEIGHT) {vy = -1*vy;}
-			shiftColliders();
-			break;
-		//Circular
-/*		case 1:
-			posX += 5*cos(PI*t/1000);
-			posY += 5*sin(PI*t/1000);
-			shiftColliders();
-			break;*/
-		//Searcher
-		case 1:
-			if(initDir){posX += vx;}
-			else{posX -= vx;}
-			if(gLevels[gLevel].tile(posX+WIDTH, posY)->getWalkability() > 0) {posY+=vy;}
-			else {posX += vx;}
-			if(gLevels[gLevel].tile(posX+WIDTH, posY+HEIGHT)->getWalkability() > 0) {posX-=vx;}
-			else {posY+=vy;}
-			if(gLevels[gLevel].tile(posX, posY+HEIGHT)->getWalkability() > 0) {posY-=vy;}
-			else {posX-=vx;}
-			if(gLevels[gLevel].tile(posX, posY)->getWalkability() > 0) {posX+=vx;}
-			else{posY-=vy;}
-			if(posX==0||posX+WIDTH==SCREEN_WIDTH){vx=-1*vx;};
-			if(posY==0||posY+HEIGHT==PLAYFIELD_HEIGHT){vy=-1*vy;};
-
-			shiftColliders();
-			break;
-		//Static
-		case 2:
-			if(frame % 10 ==0) {shoot();}
-	}
-	hit();
-}
-
-void Enemy::shiftColliders() {
-	collider.x = posX+collider.r;
-	collider.y = posY+collider.r;
-}
-
-Circle& Enemy::getCollider() {
-	return collider;
-}
-
-void Enemy::hit() {
-	for(int i = 0; i < gPlayers.size(); i++) {
-		if(checkCollision(gPlayers[i].getCollider(), collider)) {
-			if(collisionReady){
-				if(!gPlayers[i].shieldEnable) {gPlayers[i].life--;}
-				vx = -1*vx;
-				vy = -1*vy;
-			}
-			collisionReady = false;	
-		}
-		else {collisionReady = true;}
+void FramePacer::report() {
+	if(frames == 0) {
+		printf("Frame times: no frames measured\n");
+		return;
 	}
+	double mean = sum/frames;
+	double deviation = sqrt(max(sumSquares/frames-mean*mean, 0.0));
+	printf("Frame times over %d frames: mean %.3f ms (%.1f fps), jitter %.3f ms std dev, min %.3f ms, max %.3f ms\n",
+		frames, mean, 1000.0/mean, deviation, shortest, longest);
 }
 
-void Enemy::render() {
-	angle++;
-	gEnemyTexture.render(posX, posY, NULL, angle);
-}
-
-Score::Score(string playerName, int playerScore) {
-    name = playerName;
-    score = playerScore;
-}
-
-bool init() {
+bool init(int pacing) {
 	//Initialization flag
 	bool success = true;
 	//Initialize SDL
 	if(SDL_Init(SDL_INIT_VIDEO) < 0) {
-		printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+		ERROR_LOG(LOG_SYSTEM, "SDL could not initialize! SDL_Error: %s", SDL_GetError());
 		success = false;
 	} else {
 		//Set texture filtering to linear
 		if(!SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1")) {
-			printf("Warning: Linear texture filtering not enabled!");
+			WARN_LOG(LOG_RENDER, "Linear texture filtering not enabled!");
 		}
 		//Create window
 		gWindow = SDL_CreateWindow("Project", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
 		if(gWindow == NULL) {
-			printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
+			ERROR_LOG(LOG_SYSTEM, "Window could not be created! SDL Error: %s", SDL_GetError());
 			success = false;
 		} else {
+			//Adaptive vsync is a swap interval of -1, which only the OpenGL renderer can set
+			if(pacing == ADAPTIVE_VSYNC) {
+				SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
+			}
+
 			//Create renderer for window
-			gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+			Uint32 flags = SDL_RENDERER_ACCELERATED;
+			if(pacing == VSYNC || pacing == ADAPTIVE_VSYNC) {
+				flags |= SDL_RENDERER_PRESENTVSYNC;
+			}
+			gRenderer = SDL_CreateRenderer(gWindow, -1, flags);
 			if(gRenderer == NULL) {
-				printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
+				ERROR_LOG(LOG_RENDER, "Renderer could not be created! SDL Error: %s", SDL_GetError());
 				success = false;
 			} else {
+				if(pacing == ADAPTIVE_VSYNC && SDL_GL_SetSwapInterval(-1) != 0) {
+					WARN_LOG(LOG_RENDER, "Adaptive vsync not supported, using vsync! SDL Error: %s", SDL_GetError());
+				}
+
 				//Initialize renderer color
 				SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
 				//Initialize PNG loading
 				int imgFlags = IMG_INIT_PNG;
 				if(!(IMG_Init(imgFlags) & imgFlags)) {
-					printf("SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError());
+					ERROR_LOG(LOG_SYSTEM, "SDL_image could not initialize! SDL_image Error: %s", IMG_GetError());
 					success = false;
 				}
 				 //Initialize SDL_ttf
 				if(TTF_Init() == -1) {
-					printf("SDL_ttf could not initialize! SDL_ttf Error: %s\n", TTF_GetError());
+					ERROR_LOG(LOG_SYSTEM, "SDL_ttf could not initialize! SDL_ttf Error: %s", TTF_GetError());
 					success = false;
 				}
 			}
@@ -1417,149 +790,117 @@ bool loadMedia() {
 	bool success = true;
 
 	if(!gMainTexture.loadFromFile("Assets/main.png") ) {
-		printf( "Unable to render main text texture!\n" );
+		ERROR_LOG(LOG_RENDER, "Unable to render main text texture!");
 		success = false;
 	}
 	if(!gPauseTexture.loadFromFile("Assets/paused.png")) {
-		printf( "Unable to render pause text texture!\n" );
+		ERROR_LOG(LOG_RENDER, "Unable to render pause text texture!");
 		success = false;
 	}
 	if(!gPlayerOneWins.loadFromFile("Assets/p1_wins.png")) {
-		printf( "Unable to render P1 wins texture!\n" );
+		ERROR_LOG(LOG_RENDER, "Unable to render P1 wins texture!");
 		success = false;
 	}
 	if(!gPlayerTwoWins.loadFromFile("Assets/p2_wins.png")) {
-		printf( "Unable to render P2 wins texture!\n" );
+		ERROR_LOG(LOG_RENDER, "Unable to render P2 wins texture!");
 		success = false;
 	}
 
 	//load font
-	gFont = TTF_OpenFont("Assets/ostrich.ttf", 50);
+	gFont = TTF_OpenFontRW(openAsset("Assets/ostrich.ttf"), 1, 50);
 	SDL_Color textColor = {0xD0, 0xD0, 0xD0, 0xFF};
 	if(gFont == NULL) {
-		printf("Failed to load ostrich font! SDL_ttf Error: %s\n", TTF_GetError());
+		ERROR_LOG(LOG_ASSETS, "Failed to load ostrich font! SDL_ttf Error: %s", TTF_GetError());
 		success = false;
+	} else {
+		//Scoreboard text; the numbers are put together from digits every frame instead of rendering new text
+		SDL_Color hudColor = {255, 255, 255, 255};
+		bool hudText = gTimeLabelTexture.loadFromRenderedText("Time: ", hudColor) && gPlayer1LabelTexture.loadFromRenderedText("Player 1: ", hudColor)
+			&& gPlayer2LabelTexture.loadFromRenderedText("Player 2: ", hudColor);
+		for(int i = 0; i < 10; ++i) {
+			char digit[2] = {(char) ('0'+i), '\0'};
+			hudText = gDigitTextures[i].loadFromRenderedText(digit, hudColor) && hudText;
+		}
+		if(!hudText) {
+			ERROR_LOG(LOG_RENDER, "Unable to render scoreboard text!");
+			success = false;
+		}
 	}
 	
 	//Load sprites
 	if(!gSpriteSheet.loadFromFile("Assets/terrain.png")) {
-		printf("Failed to load terrain sprite sheet!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load terrain sprite sheet!");
+		success = false;
+	}
+	createTiles();
+
+	//Load the level layouts
+	if(!loadLevels("maps.txt")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load maps.txt!");
+		success = false;
+	}
+
+	//Load the enemy and power up waves of each level
+	if(!loadWaves("waves.txt")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load waves.txt!");
+		success = false;
+	}
+
+	//Load the players' spawn cells, looks and keys
+	if(!loadPlayerSlots("players.txt")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load players.txt!");
 		success = false;
-	} else {
-		for(int i = 0; i < TOTAL_TILES; ++i) {
-			gTiles[i] = new Tile(i);
-		}
 	}
 	
     //Load power up textures
 	if(!gBombPowerUPTexture.loadFromFile("Assets/bomb.png")) {
-		printf("Failed to load bomb texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load bomb texture!");
 		success = false;
 	}
 	if(!gBombTexture.loadFromFile("Assets/bomb.gif")) {
-		printf("Failed to load bomb texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load bomb texture!");
 		success = false;
 	}
 	if(!gExplosionTexture.loadFromFile("Assets/explosion.png")) {
-		printf("Failed to load bomb texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load bomb texture!");
 		success = false;
 	}
 	if(!gShieldTexture.loadFromFile("Assets/shield.png")) {
-		printf("Failed to load shield texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load shield texture!");
 		success = false;
 	}
 	if(!gLifeTexture.loadFromFile("Assets/life.png")) {
-		printf("Failed to load life texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load life texture!");
 		success = false;
 	}
 	if(!gBulletUpgradeTexture.loadFromFile("Assets/bulletUp.png")) {
-		printf("Failed to load bulletUpgrade texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load bulletUpgrade texture!");
 		success = false;
 	}
 	if(!gSpeedUpTexture.loadFromFile("Assets/speed.png")) {
-		printf("Failed to load speed texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load speed texture!");
 		success = false;
 	}
 	//Load players' life available image
 	if(!gLifeAvailableTexture.loadFromFile("Assets/lifeAvailable.png")) {
-		printf("Failed to load life available texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load life available texture!");
 		success = false;
 	}
 	//load enemy
 	if(!gEnemyTexture.loadFromFile("Assets/enemy.png")) {
-		printf("Failed to load enemy texture!\n");
+		ERROR_LOG(LOG_ASSETS, "Failed to load enemy texture!");
 		success = false;
 	}
-	return success;
-}
-
-bool checkBombCollide(Circle& player) {
-	for(int i = 0; i < gBomb.size(); i++) {
-        if(!checkCollision(player, gBomb[i].getCollider())) {
-        	gBomb[i].start = true;
-        }
-        if(checkCollision(player, gBomb[i].getCollider()) && gBomb[i].start) {
-        	return true;
-        }
-    }
-    return false;
-}
-
-bool checkEnemyCollide(Circle& player, int* life, bool collisionReady) {
-	for(int i = 0; i < gEnemies.size(); i++) {
-        if(checkCollision(player, gEnemies[i].getCollider())) {
-        	if(collisionReady) {*life = *life-1;}
-        	collisionReady = false;
-        	return true;
-        }
-        else {collisionReady = true;}
-    }
-    return false;
-}
-
-bool checkCollision(Circle& c1, Circle& c2) {
-	if(sqrt(pow(c1.x-c2.x, 2)+pow(c1.y-c2.y, 2)) < c1.r+c2.r) {
-		return true;
-	}
-	return false;
-}
-
-bool checkCollision(Circle& c1, SDL_Rect r) {
-	//Closest point on collision box
-    int cX, cY;
-    if(c1.x < r.x) {cX = r.x;}
-    else if(c1.x > r.x + r.w) {cX = r.x + r.w;}
-    else{cX = c1.x;}
-    //Find closest y offset
-    if(c1.y < r.y) {cY = r.y;}
-    else if(c1.y > r.y + r.h) {cY = r.y + r.h;}
-    else{cY = c1.y;}
-
-    //If the closest point is inside the circle
-    if(sqrt(pow(cX-c1.x, 2)+pow(cY-c1.y, 2)) < c1.r) {
-        return true;
-    }
-    return false;
-}
-
-bool checkIfEnclosed(SDL_Rect& smallerArea, SDL_Rect& largerArea) {
-	if(smallerArea.x >= largerArea.x && smallerArea.x+smallerArea.w <= largerArea.x+largerArea.w
-	&& smallerArea.y >= largerArea.y && smallerArea.y+smallerArea.h <= largerArea.y+largerArea.h) {
-		return true;
-	} else {
-		return false;
+	//load players, with and without shield
+	if(!gPlayerOneTexture.loadFromFile("Assets/p1.png") || !gPlayerOneShieldTexture.loadFromFile("Assets/p1_shield.png")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load player 1 textures!");
+		success = false;
 	}
-}
-
-void getGrassTilesPos() {
-	for(int i = Tile::WIDTH*4; i < SCREEN_WIDTH - Tile::WIDTH*4; i+=Tile::WIDTH) {
-		for(int j = Tile::WIDTH*4; j < PLAYFIELD_HEIGHT-Tile::WIDTH*4; j+=Tile::HEIGHT) {
-			if(gLevels[gLevel].tile(i,j) == gTiles[GRASS]) {
-				xTile.push_back(i);
-				yTile.push_back(j);
-			}
-		}
+	if(!gPlayerTwoTexture.loadFromFile("Assets/p2.png") || !gPlayerTwoShieldTexture.loadFromFile("Assets/p2_shield.png")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load player 2 textures!");
+		success = false;
 	}
+	return success;
 }
 
 bool sortByScore(const Score &lhs,const Score &rhs) {
@@ -1575,7 +916,7 @@ void recordScore() {
         }
         myfile_Read.close();
     }
-    else cout << "Unable to open file";
+    else WARN_LOG(LOG_IO, "Unable to open score.txt");
     //get the name and score separated by a coma
     for(int i = 0; i<data.size(); i++) {
         playerName = data[i].substr(0,data[i].find(delim));
@@ -1611,33 +952,215 @@ void recordScore() {
     myfile.close();
 }
 
-void restart() {
-    SDL_RenderClear(gRenderer);
-    gPlayers[0].playerRect.x = 5;
-    gPlayers[0].playerRect.y = 5;
-    gPlayers[0].shiftColliders();
-    gPlayers[1].playerRect.x = SCREEN_WIDTH-Player::WIDTH-5;
-    gPlayers[1].playerRect.y = PLAYFIELD_HEIGHT-Player::HEIGHT-5;
-    gPlayers[1].shiftColliders();
-    for(auto &Bullet: gBullets) {
-        gBullets.erase(gBullets.begin(),gBullets.end());
-    }
-    for(int i = 0; i < gPlayers.size(); i++) {
-        gPlayers[i].renderLifeTexture();
-        gPlayers[i].life = 5;
-    }
-	gLevel = (gLevel+1)%LEVELS;
-    reset = false;
+bool loadReplay(string path, Uint32& seed, vector< vector<Uint8> >& inputs) {
+	ifstream replay(path.c_str(), ios::binary);
+	Uint8 header[9];
+	if(!replay.read((char*) header, sizeof(header)) || header[0] != 'B' || header[1] != 'M' || header[2] != 'R' || header[3] != 'P' || header[8] == 0) {
+		return false;
+	}
+	seed = header[4] | (header[5] << 8) | (header[6] << 16) | ((Uint32) header[7] << 24);
+
+	//One byte per player per tick
+	int players = header[8];
+	inputs.assign(max(players, 2), vector<Uint8>());
+	char tickInputs[256];
+	while(replay.read(tickInputs, players)) {
+		for(int i = 0; i < players; ++i) {
+			inputs[i].push_back(tickInputs[i]);
+		}
+	}
+	return true;
+}
+
+void renderGame(GameWorld& world) {
+	//Viewports
+	SDL_Rect scoreboard = {0, 0, SCREEN_WIDTH, SCOREBOARD_HEIGHT};
+	SDL_Rect playfield = {0, SCOREBOARD_HEIGHT, SCREEN_WIDTH, PLAYFIELD_HEIGHT};
+
+	SDL_RenderClear(gRenderer);
+	SDL_RenderSetViewport(gRenderer, &scoreboard);
+
+	SDL_SetRenderDrawColor(gRenderer, 0x00, 0x80, 0x80, 0xFF);
+	SDL_RenderFillRect(gRenderer, &scoreboard);
+
+	renderHudLine(gTimeLabelTexture, world.timeLeft(), (SCREEN_WIDTH-hudLineWidth(gTimeLabelTexture, world.timeLeft()))/2);
+	if(world.players.size() == 2) {
+		renderHudLine(gPlayer1LabelTexture, world.players[0].score, (SCREEN_WIDTH-hudLineWidth(gPlayer1LabelTexture, world.players[0].score))/2-300);
+		renderHudLine(gPlayer2LabelTexture, world.players[1].score, (SCREEN_WIDTH-hudLineWidth(gPlayer2LabelTexture, world.players[1].score))/2+250);
+		world.players[0].getTexture()->render(30, 15);
+		world.players[1].getTexture()->render(SCREEN_WIDTH-SCREEN_WIDTH/6-30, 15);
+		world.players[0].renderLifeTexture(60, 15);
+		world.players[1].renderLifeTexture(SCREEN_WIDTH-SCREEN_WIDTH/6, 15);
+	} else {
+		//No room for a line each: two rows of sprite, score and lives, half the columns either side of the clock
+		int clockWidth = hudLineWidth(gTimeLabelTexture, 88)+40;
+		int columns = (world.players.size()+1)/2;
+		int columnWidth = (SCREEN_WIDTH-clockWidth)/columns;
+		for(int i = 0; i < world.players.size(); i++) {
+			int column = i/2;
+			int x = column*columnWidth+(column >= columns/2 ? clockWidth : 0)+10;
+			int y = 5+i%2*SCOREBOARD_HEIGHT/2;
+			world.players[i].getTexture()->render(x, y);
+			x += Player::WIDTH+5;
+			x += renderSmallNumber(world.players[i].score, x, y, Player::HEIGHT)+10;
+			world.players[i].renderLifeTexture(x, y);
+		}
+	}
+
+	SDL_RenderSetViewport(gRenderer, &playfield);
+
+	if(gCpuTiles) {
+		gTileCanvas.render(world.map(), world.frame);
+	} else {
+		world.map().render(world.frame);
+	}
+
+	for(int i = 0; i < world.enemyBullets.size(); ++i) {
+		world.enemyBullets[i].render();
+	}
+
+	for(int i = 0; i < world.powerUps.size(); i++) {
+		world.powerUps[i].render();
+	}
+	for(int i = 0; i < world.enemies.size(); i++) {
+		world.enemies[i].render();
+	}
+	world.horde.render();
+
+	for(int i = 0; i < world.bullets.size(); ++i) {
+		world.bullets[i].render();
+	}
+
+	for(int i = 0; i<world.bombs.size(); i++) {
+		world.bombs[i].render();
+	}
+	for(int i = 0; i<world.explosions.size(); i++) {
+		world.explosions[i].renderExplosion();
+		gParticles.explosion(world.explosions[i].getCollider().x, world.explosions[i].getCollider().y);
+	}
+	world.explosions.clear();
+	for(int i = 0; i < world.impacts.size(); i++) {
+		gParticles.impact(world.impacts[i].x, world.impacts[i].y);
+	}
+	world.impacts.clear();
+
+	for(int i = 0; i < world.players.size(); i++) {
+		world.players[i].render();
+	}
+
+	//Everything above went into the queue; draw it by layer and texture
+	gRenderQueue.submit();
+
+	gParticles.render();
+}
+
+int hudLineWidth(LTexture& label, int value) {
+	int width = label.getWidth();
+	do {
+		width += gDigitTextures[value%10].getWidth();
+		value /= 10;
+	} while(value > 0);
+	return width;
+}
+
+void renderHudLine(LTexture& label, int value, int x) {
+	label.render(x, (SCOREBOARD_HEIGHT-label.getLength())/2);
+	x += label.getWidth();
+
+	//Digits come out least significant first
+	int digits[10];
+	int count = 0;
+	do {
+		digits[count++] = value%10;
+		value /= 10;
+	} while(value > 0);
+	while(count > 0) {
+		LTexture& digit = gDigitTextures[digits[--count]];
+		digit.render(x, (SCOREBOARD_HEIGHT-digit.getLength())/2);
+		x += digit.getWidth();
+	}
+}
+
+int renderSmallNumber(int value, int x, int y, int height) {
+	int digits[10];
+	int count = 0;
+	do {
+		digits[count++] = value%10;
+		value /= 10;
+	} while(value > 0);
+	int start = x;
+	while(count > 0) {
+		LTexture& digit = gDigitTextures[digits[--count]];
+		SDL_Rect dst = {x, y, digit.getWidth()*height/max(digit.getLength(), 1), height};
+		digit.render(&dst);
+		x += dst.w;
+	}
+	return x-start;
+}
+
+void benchmarkTiles() {
+	static const int FRAMES = 600;
+	SDL_Rect playfield = {0, SCOREBOARD_HEIGHT, SCREEN_WIDTH, PLAYFIELD_HEIGHT};
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+
+	SDL_RendererInfo info;
+	if(SDL_GetRendererInfo(gRenderer, &info) == 0) {
+		printf("Renderer: %s\n", info.name);
+	}
+
+	for(int pass = 0; pass < 2; ++pass) {
+		bool cpu = pass == 1;
+		if(cpu && !gTileCanvas.load("Assets/terrain.png")) {
+			ERROR_LOG(LOG_RENDER, "Failed to set up CPU tile drawing!");
+			return;
+		}
+		Map map = gLevelLayouts[0];
+		gTileCanvas.cellsDrawn = 0;
+		gTileCanvas.rowsUploaded = 0;
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		for(int i = 0; i < FRAMES; ++i) {
+			//Break a brick now and then, as a match would
+			if(i%15 == 0) {
+				map.hit(i*7%Map::COLS*Tile::WIDTH, i*5%Map::ROWS*Tile::HEIGHT);
+			}
+			SDL_RenderSetViewport(gRenderer, NULL);
+			SDL_RenderClear(gRenderer);
+			SDL_RenderSetViewport(gRenderer, &playfield);
+			if(cpu) {
+				gTileCanvas.render(map, i);
+			} else {
+				map.render(i);
+				gRenderQueue.submit();
+			}
+			SDL_RenderPresent(gRenderer);
+			gFrameArena.reset();
+		}
+		double ms = (double) (SDL_GetPerformanceCounter()-start)*1000/frequency/FRAMES;
+
+		if(cpu) {
+			printf("Tiles via CPU canvas: %.3f ms per frame (%.0f fps), %.1f cells and %.1f rows uploaded per frame\n",
+				ms, 1000/ms, (double) gTileCanvas.cellsDrawn/FRAMES, (double) gTileCanvas.rowsUploaded/FRAMES);
+		} else {
+			printf("Tiles via SDL_Renderer: %.3f ms per frame (%.0f fps), %d copies per frame\n", ms, 1000/ms, Map::COLS*Map::ROWS);
+		}
+	}
 }
 
 void close() {
 	//Free loaded images
 	gPauseTexture.free();
 	gMainTexture.free();
-	gTimeTextTexture.free();
+	gTimeLabelTexture.free();
+	gPlayer1LabelTexture.free();
+	gPlayer2LabelTexture.free();
+	for(int i = 0; i < 10; ++i) {
+		gDigitTextures[i].free();
+	}
 	gLifeAvailableTexture.free();
 	gPlayerOneWins.free();
 	gPlayerTwoWins.free();
+	gPlayerWinsTexture.free();
 
 	gBombPowerUPTexture.free();
 	gShieldTexture.free();
@@ -1650,10 +1173,12 @@ void close() {
 
 	gPlayerOneTexture.free();
 	gPlayerTwoTexture.free();
+	gPlayerOneShieldTexture.free();
+	gPlayerTwoShieldTexture.free();
 	gEnemyTexture.free();
 
 	gSpriteSheet.free();
-	mapReader.close();
+	gTileCanvas.free();
 
 	//Free global font
 	TTF_CloseFont(gFont);
@@ -0,0 +1,49 @@
+#include "framearena.h"
+#include "logger.h"
+
+FrameArena gFrameArena(256*1024);
+
+FrameArena::FrameArena(size_t size):
+	block(size), used(0), needed(0) {}
+
+FrameArena::~FrameArena() {
+	for(int i = 0; i < spilled.size(); ++i) {
+		delete[] spilled[i];
+	}
+}
+
+void* FrameArena::alloc(size_t bytes, size_t align) {
+	needed = ((needed+align-1) & ~(align-1))+bytes;
+	size_t start = (used+align-1) & ~(align-1);
+	if(start+bytes <= block.size()) {
+		used = start+bytes;
+		return block.data()+start;
+	}
+
+	char* memory = new char[bytes+align];
+	spilled.push_back(memory);
+	return memory+(align-(size_t) memory%align)%align;
+}
+
+void FrameArena::reserve(size_t size) {
+	if(size > block.size()) {
+		block.assign(size, 0);
+	}
+}
+
+void FrameArena::reset() {
+	if(!spilled.empty()) {
+		for(int i = 0; i < spilled.size(); ++i) {
+			delete[] spilled[i];
+		}
+		spilled.clear();
+
+		//Room for a frame like that one from now on
+		size_t size = block.size();
+		while(size < needed) {size *= 2;}
+		WARN_LOG(LOG_SYSTEM, "Frame scratch grown from %d to %d KB", (int) block.size()/1024, (int) size/1024);
+		block.assign(size, 0);
+	}
+	used = 0;
+	needed = 0;
+}
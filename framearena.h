@@ -0,0 +1,36 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+//Scratch memory for one frame. Allocating bumps a pointer; reset() at the start of the next frame frees it all.
+//Only for plain data: nothing is constructed or destroyed. A frame that needs more than the block spills onto
+//the heap, and the next reset() grows the block to fit, so a busier frame costs one allocation, not one per frame.
+class FrameArena{
+		vector<char> block;
+		size_t used;
+		size_t needed;	//Bytes the current frame asked for, spilled or not
+		vector<char*> spilled;
+
+	public:
+		FrameArena(size_t size);
+		~FrameArena();
+
+		void* alloc(size_t bytes, size_t align);
+		template<class T> T* allocArray(int count) {return static_cast<T*>(alloc(count*sizeof(T), alignof(T)));}
+
+		void reset();
+		size_t capacity() {return block.size();}
+
+		//Grows the block to at least size bytes ahead of time; only between frames
+		void reserve(size_t size);
+};
+
+//Scratch for the frame being rendered
+extern FrameArena gFrameArena;
+
+#endif
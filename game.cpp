@@ -0,0 +1,1530 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+#include "bundle.h"
+#include "game.h"
+#include "logger.h"
+#include "renderqueue.h"
+#include "telemetry.h"
+
+//The window renderer
+SDL_Renderer* gRenderer = NULL;
+
+//Globally used font
+TTF_Font* gFont = NULL;
+
+//Textures
+LTexture gPlayerOneTexture;
+LTexture gPlayerTwoTexture;
+LTexture gPlayerOneShieldTexture;
+LTexture gPlayerTwoShieldTexture;
+LTexture gEnemyTexture;
+
+LTexture gBombPowerUPTexture;
+LTexture gShieldTexture;
+LTexture gLifeTexture;
+LTexture gBulletUpgradeTexture;
+LTexture gSpeedUpTexture;
+LTexture gLifeAvailableTexture;
+
+LTexture gBombTexture;
+LTexture gExplosionTexture;
+
+LTexture gSpriteSheet;
+Tile* gTiles[TOTAL_TILES];
+
+vector<Map> gLevelLayouts;
+vector<WaveSchedule> gWaveSchedules;
+vector<PlayerSlot> gPlayerSlots;
+
+//LIFE, BOMB, SHIELD, BULLETUPGRADE, SPEEDUP
+LTexture* powerUpsTex[NPOWERUPS] = {&gLifeTexture, &gBombPowerUPTexture, &gShieldTexture, &gBulletUpgradeTexture, &gSpeedUpTexture};
+
+//Most power ups or enemies any level has on the field at once; the entity pools are made this big
+static int largestWave(bool enemies) {
+	int largest = 0;
+	for(int i = 0; i < gWaveSchedules.size(); ++i) {
+		largest = max(largest, enemies ? gWaveSchedules[i].peakEnemies : gWaveSchedules[i].peakPowerUps);
+	}
+	return largest;
+}
+
+LTexture::LTexture() {
+	static int textures = 0;
+
+	//Initialize
+	mTexture = NULL;
+	mWidth = 0;
+	mLength = 0;
+	mId = ++textures;
+}
+
+LTexture::~LTexture() {
+	//Deallocate
+	free();
+}
+
+bool LTexture::loadFromFile(const string& path) {
+	//Get rid of preexisting texture
+	free();
+
+	//The final texture
+	SDL_Texture* newTexture = NULL;
+
+	//Load image at specified path, from the bundle if it's there
+	SDL_Surface* loadedSurface = IMG_Load_RW(openAsset(path), 1);
+
+	if(loadedSurface == NULL) {
+		ERROR_LOG(LOG_ASSETS, "Unable to load image %s! SDL_image Error: %s", path.c_str(), IMG_GetError());
+	} else {
+		//Color key image
+		SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, 0xFF, 0xFF, 0xFF));
+
+		//Create texture from surface pixels
+		newTexture = SDL_CreateTextureFromSurface(gRenderer, loadedSurface);
+
+		if(newTexture == NULL) {
+			ERROR_LOG(LOG_ASSETS, "Unable to create texture from %s! SDL Error: %s", path.c_str(), SDL_GetError());
+		} else {
+			//Get image dimensions
+			mWidth = loadedSurface->w;
+			mLength = loadedSurface->h;
+		}
+
+		//Get rid of loaded surface
+		SDL_FreeSurface(loadedSurface);
+	}
+
+	//Return success
+	mTexture = newTexture;
+	return mTexture != NULL;
+}
+
+#ifdef _SDL_TTF_H
+bool LTexture::loadFromRenderedText(const char* textureText, SDL_Color textColor) {
+	//Get rid of preexisting texture
+	free();
+
+	//Render text surface
+	SDL_Surface* textSurface = TTF_RenderText_Solid(gFont, textureText, textColor);
+	if(textSurface == NULL) {
+		ERROR_LOG(LOG_RENDER, "Unable to render text surface! SDL_ttf Error: %s", TTF_GetError());
+	} else {
+		//Create texture from surface pixels
+		mTexture = SDL_CreateTextureFromSurface(gRenderer, textSurface);
+		if(mTexture == NULL) {
+			ERROR_LOG(LOG_RENDER, "Unable to create texture from rendered text! SDL Error: %s", SDL_GetError());
+		} else {
+			//Get image dimensions
+			mWidth = textSurface->w;
+			mLength = textSurface->h;
+		}
+		SDL_FreeSurface(textSurface);
+	}
+	return mTexture != NULL;
+}
+#endif
+
+void LTexture::free() {
+	//Free texture if it exists
+	if(mTexture != NULL) {
+		SDL_DestroyTexture(mTexture);
+		mTexture = NULL;
+		mWidth = 0;
+		mLength = 0;
+	}
+}
+
+void LTexture::setColor(Uint8 red, Uint8 green, Uint8 blue) {
+	//Modulate texture
+	SDL_SetTextureColorMod(mTexture, red, green, blue);
+}
+
+void LTexture::setBlendMode(SDL_BlendMode blending) {
+	//Set blending function
+	SDL_SetTextureBlendMode(mTexture, blending);
+}
+
+void LTexture::setAlpha(Uint8 alpha) {
+	//Modulate texture alpha
+	SDL_SetTextureAlphaMod(mTexture, alpha);
+}
+
+void LTexture::render(SDL_Rect* dst, SDL_Rect* src, double angle, SDL_Point* center, SDL_RendererFlip flip) {
+	//Set clip rendering dimensions
+	if(dst->w == 0 || dst->h == 0) {
+		dst->w = mWidth;
+		dst->h = mLength;
+	}
+	//Render to screen
+	SDL_RenderCopyEx(gRenderer, mTexture, src, dst, angle, center, flip);
+}
+
+void LTexture::render(int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip) {
+	//Set rendering space and render to screen
+	SDL_Rect renderQuad = {x, y, mWidth, mLength};
+
+	//Set clip rendering dimensions
+	if(clip != NULL) {
+		renderQuad.w = clip->w;
+		renderQuad.h = clip->h;
+	}
+	//Render to screen
+	SDL_RenderCopyEx(gRenderer, mTexture, clip, &renderQuad, angle, center, flip);
+}
+
+int LTexture::getWidth() {
+	return mWidth;
+}
+
+int LTexture::getLength() {
+	return mLength;
+}
+
+int LTexture::getId() {
+	return mId;
+}
+
+int Tile::getTileType() {
+	return tileType;
+}
+
+int Tile::getWalkability() {
+	return TILE_TRAITS[tileType].walkability;
+}
+
+int Tile::getDirection() {
+	return TILE_TRAITS[tileType].direction;
+}
+
+int Tile::getFrames() {
+	return TILE_TRAITS[tileType].frames;
+}
+
+SDL_Rect Tile::getRenderSrc(int frame) {
+	const TileTraits& traits = TILE_TRAITS[tileType];
+	return {traits.srcX+32*(frame/2%traits.frames), traits.srcY, 32, 32};
+}
+
+void Tile::render(int frame, SDL_Rect renderDst) {
+	SDL_Rect src = getRenderSrc(frame);
+	gRenderQueue.push(LAYER_TILES, &gSpriteSheet, renderDst, &src, getDirection()*90);
+}
+
+Map::Map(istream& mapReader) {
+	string mapName;
+	
+	if(!mapReader.eof()) {
+		while(mapReader.good() && mapReader.get() != '[') {}
+		getline(mapReader, mapName, ']');
+	}
+	
+	for(int i = 0; i < Map::ROWS; ++i) {
+		for(int j = 0; j < Map::COLS; ++j) {
+			int tileType;
+			if(!mapReader.eof()) {
+				mapReader >> tileType;
+				if(tileType < 0 || tileType >= TOTAL_TILES) {tileType = 0;}
+			} else {
+				tileType = 0;
+			}
+			tileMap[j][i] = gTiles[tileType];
+		}
+	}
+
+	t.w = Tile::WIDTH;
+	t.h = Tile::HEIGHT;
+
+	findSpawnCells();
+}
+
+Tile* Map::tile(int x, int y) {
+	if(x >= 0 && x < Tile::WIDTH*Map::COLS
+		&& y >= 0 && y < Tile::HEIGHT*Map::ROWS) {
+		return tileMap[x/Tile::WIDTH][y/Tile::HEIGHT];
+	} else {
+		return gTiles[STEEL];
+	}
+}
+
+void Map::hit(int x, int y) {
+	if(TileSet<Breakable>::has(tile(x, y)->getTileType())) {
+		tileMap[x/Tile::WIDTH][y/Tile::HEIGHT] = gTiles[GRASS];
+		addSpawnCell(x/Tile::WIDTH, y/Tile::HEIGHT);
+	}
+}
+
+SDL_Point Map::openCell(int col, int row) {
+	//Rings of cells further and further out, each in the same order, so every world picks the same one
+	int reach = COLS > ROWS ? COLS : ROWS;
+	for(int r = 0; r < reach; ++r) {
+		for(int i = max(col-r, 0); i <= min(col+r, COLS-1); ++i) {
+			for(int j = max(row-r, 0); j <= min(row+r, ROWS-1); ++j) {
+				if(max(abs(i-col), abs(j-row)) != r) {continue;}
+				if(tileMap[i][j] == gTiles[GRASS] || tileMap[i][j] == gTiles[BRICK]) {
+					hit(i*Tile::WIDTH, j*Tile::HEIGHT);
+					return {i*Tile::WIDTH, j*Tile::HEIGHT};
+				}
+			}
+		}
+	}
+	return {col*Tile::WIDTH, row*Tile::HEIGHT};
+}
+
+int Map::trace(double x0, double y0, double x1, double y1, int tileMask, SDL_Point& cell, double& t) {
+	int col = (int) floor(x0/Tile::WIDTH), row = (int) floor(y0/Tile::HEIGHT);
+	int lastCol = (int) floor(x1/Tile::WIDTH), lastRow = (int) floor(y1/Tile::HEIGHT);
+	double dx = x1-x0, dy = y1-y0;
+	int stepX = dx > 0 ? 1 : (dx < 0 ? -1 : 0), stepY = dy > 0 ? 1 : (dy < 0 ? -1 : 0);
+
+	//How far along the segment the next vertical and horizontal cell borders are, and the distance between borders
+	double nextX = stepX != 0 ? ((col+(stepX > 0))*Tile::WIDTH-x0)/dx : HUGE_VAL;
+	double nextY = stepY != 0 ? ((row+(stepY > 0))*Tile::HEIGHT-y0)/dy : HUGE_VAL;
+	double deltaX = stepX != 0 ? Tile::WIDTH/fabs(dx) : HUGE_VAL;
+	double deltaY = stepY != 0 ? Tile::HEIGHT/fabs(dy) : HUGE_VAL;
+
+	t = 0;
+	for(;;) {
+		if(col < 0 || col >= COLS || row < 0 || row >= ROWS) {
+			return TRACE_OFF_MAP;
+		}
+		if(tileMask & (1<<tileMap[col][row]->getTileType())) {
+			cell = {col, row};
+			return TRACE_TILE;
+		}
+		if(col == lastCol && row == lastRow) {
+			return TRACE_CLEAR;
+		}
+		if(nextX < nextY) {
+			col += stepX;
+			t = nextX;
+			nextX += deltaX;
+		} else {
+			row += stepY;
+			t = nextY;
+			nextY += deltaY;
+		}
+	}
+}
+
+SDL_Point Map::sweep(const SDL_Rect& box, SDL_Point move) {
+	SDL_Point allowed;
+	allowed.x = sweepAxis(box.x, box.w, move.x, box.y, box.h, false);
+	allowed.y = sweepAxis(box.y, box.h, move.y, box.x+allowed.x, box.w, true);
+	return allowed;
+}
+
+//Cell holding a pixel coordinate, rounding down for those left of or above the map
+static int cellOf(int p, int cellSize) {
+	return p >= 0 ? p/cellSize : (p+1)/cellSize-1;
+}
+
+int Map::sweepAxis(int pos, int size, int d, int across, int acrossSize, bool vertical) {
+	if(d == 0) {return 0;}
+	int cellSize = vertical ? Tile::HEIGHT : Tile::WIDTH, acrossCellSize = vertical ? Tile::WIDTH : Tile::HEIGHT;
+	int step = d > 0 ? 1 : -1;
+	int lead = d > 0 ? pos+size-1 : pos;
+	int first = cellOf(across, acrossCellSize), last = cellOf(across+acrossSize-1, acrossCellSize);
+
+	//Cells the leading edge enters, nearest first; the first blocked one decides how far it gets
+	for(int c = cellOf(lead, cellSize)+step; c != cellOf(lead+d, cellSize)+step; c += step) {
+		for(int k = first; k <= last; ++k) {
+			if(vertical ? blocks(k, c) : blocks(c, k)) {
+				return d > 0 ? c*cellSize-1-lead : (c+1)*cellSize-lead;
+			}
+		}
+	}
+	return d;
+}
+
+bool Map::blocks(int col, int row) {
+	return col < 0 || col >= COLS || row < 0 || row >= ROWS || TileSet<Blocking>::has(tileMap[col][row]->getTileType());
+}
+
+void Map::addSpawnCell(int col, int row) {
+	int cell = col*ROWS+row;
+	if(col < SPAWN_MARGIN || col >= COLS-SPAWN_MARGIN || row < SPAWN_MARGIN || row >= ROWS-SPAWN_MARGIN || spawnSlot[cell] >= 0) {
+		return;
+	}
+	spawnSlot[cell] = spawnCount;
+	spawnCells[spawnCount++] = cell;
+}
+
+void Map::findSpawnCells() {
+	spawnCount = 0;
+	for(int i = 0; i < COLS*ROWS; ++i) {
+		spawnSlot[i] = -1;
+	}
+	for(int i = 0; i < COLS; ++i) {
+		for(int j = 0; j < ROWS; ++j) {
+			if(tileMap[i][j] == gTiles[GRASS]) {addSpawnCell(i, j);}
+		}
+	}
+}
+
+SDL_Point Map::spawnCell(int i) {
+	return {spawnCells[i]/ROWS*Tile::WIDTH, spawnCells[i]%ROWS*Tile::HEIGHT};
+}
+
+void Map::saveSpawnCells(Snapshot& s) {
+	s.put(spawnCount);
+	s.write(spawnCells, spawnCount*sizeof(spawnCells[0]));
+}
+
+bool Map::loadSpawnCells(Snapshot& s) {
+	if(!s.get(spawnCount) || spawnCount < 0 || spawnCount > COLS*ROWS || !s.read(spawnCells, spawnCount*sizeof(spawnCells[0]))) {
+		return false;
+	}
+	for(int i = 0; i < COLS*ROWS; ++i) {
+		spawnSlot[i] = -1;
+	}
+	for(int i = 0; i < spawnCount; ++i) {
+		if(spawnCells[i] < 0 || spawnCells[i] >= COLS*ROWS) {return false;}
+		spawnSlot[spawnCells[i]] = i;
+	}
+	return true;
+}
+
+void Map::render(int frame) {
+	for(int i = 0; i < ROWS; ++i) {
+		for(int j = 0; j < COLS; ++j) {
+			t.x = j*Tile::WIDTH;
+			t.y = i*Tile::HEIGHT;
+			
+			tileMap[j][i]->render(frame, t);
+		}
+	}
+}
+
+void Player::act(GameWorld& world, Uint8 input) {
+    if(!world.disableCon) {
+		if(input & (1<<SHOOT)) {shoot(world);}
+		if((input & (1<<PLACEBOMB)) && bombEnable) {placeBomb(world);}
+
+		if(input & (1<<UP)) {move(world, 0, -vel); dir = NORTH;}
+		if(input & (1<<LEFT)) {move(world, -vel, 0); dir = WEST;}
+		if(input & (1<<DOWN)) {move(world, 0, vel); dir = SOUTH;}
+		if(input & (1<<RIGHT)) {move(world, vel, 0); dir = EAST;}
+	}
+
+	react(world);
+}
+
+void Player::react(GameWorld& world) {
+	SDL_Rect tileBoxOfOrigin = {playerRect.x-playerRect.x%Tile::WIDTH, playerRect.y-playerRect.y%Tile::HEIGHT, Tile::WIDTH, Tile::HEIGHT};
+	
+	if(TileSet<Slide>::has(world.map().tile(playerRect.x, playerRect.y)->getTileType())
+	&& (checkIfEnclosed(playerRect, tileBoxOfOrigin) || wasPreviouslyOnSlidewalk)) {
+		if(checkIfEnclosed(playerRect, tileBoxOfOrigin)) {
+			lastEnteredSlidewalk = tileBoxOfOrigin;
+		}
+		dir = (world.map().tile(lastEnteredSlidewalk.x, lastEnteredSlidewalk.y)->getDirection()+1)%4;
+		wasPreviouslyOnSlidewalk = true;
+		
+		switch(dir) {
+			case SOUTH: move(world, 0, vel); break;
+			case WEST: move(world, -vel, 0); break;
+			case NORTH: move(world, 0, -vel); break;
+			case EAST: move(world, vel, 0); break;
+		}
+	} else if(checkIfEnclosed(playerRect, tileBoxOfOrigin)) {
+		wasPreviouslyOnSlidewalk = false;
+	}
+}
+
+void Player::move(GameWorld& world, int vx, int vy) {
+    int lifeBefore = life;
+    //Tiles are tested out to x+WIDTH and y+HEIGHT. Walls only cut a move short, so players slide up flush against them
+    SDL_Rect box{playerRect.x, playerRect.y, WIDTH+1, HEIGHT+1};
+    SDL_Point allowed = world.map().sweep(box, {vx, vy});
+
+    playerRect.x += allowed.x;//whatever the position of the rectangle is will also be the position where the rectangel will be rendered
+    shiftColliders();
+
+    //Other players, bombs and enemies still undo the whole step
+    if(touchesPlayer(world)
+	|| (world.checkBombCollide(collider))
+	|| (world.checkEnemyCollide(collider, &life, collisionReady))
+	) {
+		playerRect.x -= allowed.x;
+		shiftColliders();
+		if(allowed.x != 0) {
+			box.x = playerRect.x;
+			allowed.y = world.map().sweep(box, {0, vy}).y;
+		}
+    }
+
+	playerRect.y += allowed.y;//whatever the position of the rectangle is will also be the position where the rectangel will be rendered
+    shiftColliders();
+
+    if(touchesPlayer(world)
+	|| (world.checkBombCollide(collider))
+	|| (world.checkEnemyCollide(collider, &life, collisionReady))
+	) {
+		playerRect.y -= allowed.y;
+		shiftColliders();
+    }
+
+    //Walked into an enemy
+    if(life < lifeBefore) {
+        world.record(EVENT_HIT, this-world.players.data(), playerRect.x, playerRect.y, HIT_ENEMY);
+    }
+    world.playerGrid.place(this-world.players.data(), collider.x, collider.y);
+}
+
+bool Player::touchesPlayer(GameWorld& world) {
+	int self = this-world.players.data();
+	return world.playerGrid.find(collider.x, collider.y, [&](int i) {return i != self && checkCollision(collider, world.players[i].getCollider());}) >= 0;
+}
+
+Circle& Player::getCollider() {
+	return collider;
+}
+
+void Player::shiftColliders() {
+	collider.x = playerRect.x+collider.r;
+	collider.y = playerRect.y+collider.r;
+}
+
+void Player::shoot(GameWorld& world) {
+   world.record(EVENT_SHOT, this-world.players.data(), playerRect.x, playerRect.y, dir);
+   if(bulletUpEnable == false) {
+        if(dir == EAST) world.bullets.spawn((playerRect.x+WIDTH), (playerRect.y+HEIGHT/2), dir);
+        else if(dir == WEST) world.bullets.spawn((playerRect.x-WIDTH/4), (playerRect.y+HEIGHT/2), dir);
+        else if(dir == SOUTH) world.bullets.spawn((playerRect.x+WIDTH/2), (playerRect.y+HEIGHT), dir);
+        else if(dir == NORTH) world.bullets.spawn((playerRect.x+WIDTH/2), (playerRect.y-HEIGHT/4), dir);
+    }
+    else if(bulletUpEnable == true) {
+        world.bullets.spawn((playerRect.x+WIDTH), (playerRect.y+HEIGHT/2), EAST);
+        world.bullets.spawn((playerRect.x-WIDTH), (playerRect.y+HEIGHT/2), WEST);
+        world.bullets.spawn((playerRect.x+WIDTH/2), (playerRect.y+HEIGHT), SOUTH);
+        world.bullets.spawn((playerRect.x+WIDTH/2), (playerRect.y-HEIGHT), NORTH);
+    }
+}
+
+void Player::placeBomb(GameWorld& world) {
+    world.record(EVENT_BOMB_PLACED, this-world.players.data(), playerRect.x, playerRect.y);
+    world.bombs.spawn(playerRect.x, playerRect.y, world.frame);
+}
+
+void Player::save(Snapshot& s) {
+	s.put(playerRect);
+	s.put(collider);
+	s.put(dir);
+	s.put(wasPreviouslyOnSlidewalk);
+	s.put(lastEnteredSlidewalk);
+	s.put(score);
+	s.put(life);
+	s.put(vel);
+	s.put(shieldEnable);
+	s.put(bulletUpEnable);
+	s.put(bombEnable);
+	s.put(collisionReady);
+	s.put(shieldStart);
+	s.put(bombStart);
+	s.put(pickups);
+}
+
+bool Player::load(Snapshot& s) {
+	return s.get(playerRect) && s.get(collider) && s.get(dir) && s.get(wasPreviouslyOnSlidewalk) && s.get(lastEnteredSlidewalk)
+		&& s.get(score) && s.get(life) && s.get(vel) && s.get(shieldEnable) && s.get(bulletUpEnable) && s.get(bombEnable)
+		&& s.get(collisionReady) && s.get(shieldStart) && s.get(bombStart) && s.get(pickups);
+}
+
+LTexture* Player::getTexture() {
+	return shieldEnable ? shieldTex : playerTex;
+}
+
+void Player::render() {
+	gRenderQueue.push(LAYER_PLAYERS, getTexture(), playerRect, NULL, 90*dir);
+}
+
+void Player::renderLifeTexture(int x, int y) {
+	for(int i = 0; i < life; i++) {
+		gLifeAvailableTexture.render(x+(gLifeAvailableTexture.getWidth()*i), y);
+	}
+}
+
+void Player::activatePowerUp(GameWorld& world, int id) {
+	++pickups[id];
+	world.record(EVENT_PICKUP, this-world.players.data(), playerRect.x, playerRect.y, id);
+	if(world.verbose) {DEBUG_LOG(LOG_GAME, "Player %d picked up power up %d", (int) (this-world.players.data())+1, id);}
+	switch(id) {
+		case LIFE:
+			if(life <= 7)life++;
+			break;
+		case BOMB:
+            bombStart = world.frame;
+            bombEnable = true;
+            break;
+		case SHIELD:
+			shieldStart = world.frame;
+			shieldEnable = true;
+			break;
+		case BULLETUPGRADE:
+            bulletUpEnable = true;
+			break;
+		case SPEEDUP:
+            vel++;
+			break;
+	}
+}
+
+PowerUp::PowerUp(GameWorld& world, int pwrUp_id, int wave):
+	wave(wave) {
+	//gets a random position to place the powerup
+	SDL_Point cell = world.spawnPoint();
+	powerUpRect = {cell.x+Tile::WIDTH/5, cell.y+Tile::HEIGHT/5, WIDTH, HEIGHT};
+	id = pwrUp_id;
+	collider = {cell.x+Tile::WIDTH/5+WIDTH/2, cell.y+Tile::HEIGHT/5+WIDTH/2, WIDTH/2};
+}
+
+void PowerUp::render() {
+	gRenderQueue.push(LAYER_ITEMS, powerUpsTex[id], powerUpRect);
+}
+
+int PowerUp::getPowerUpID() {
+	return id;
+}
+
+Circle& PowerUp::getCollider() {
+    return collider;
+}
+
+int Bullet::sweep(GameWorld& world, double dx, double dy, const SDL_Point* corners, int cornerCount, SDL_Point& cell, int& player) {
+	//The first wall any corner runs into, or the edge of the map, ends the move there
+	double reach = 1;
+	int stop = TRACE_CLEAR;
+	for(int i = 0; i < cornerCount; ++i) {
+		SDL_Point c;
+		double t;
+		int result = world.map().trace(x+corners[i].x, y+corners[i].y, x+corners[i].x+dx, y+corners[i].y+dy, STOPPED_BY, c, t);
+		if(result != TRACE_CLEAR && (stop == TRACE_CLEAR || t < reach)) {
+			stop = result;
+			reach = t;
+			if(result == TRACE_TILE) {cell = c;}
+		}
+	}
+
+	//Players on the way there, looked for at least every half player so none is skipped at any speed
+	int steps = max((int) ceil(sqrt(dx*dx+dy*dy)*reach/(Player::WIDTH/2)), 1);
+	double startX = x, startY = y;
+	for(int k = 1; k <= steps; ++k) {
+		x = startX+dx*reach*k/steps;
+		y = startY+dy*reach*k/steps;
+		SDL_Rect box{(int) x, (int) y, WIDTH, HEIGHT};
+		player = world.playerGrid.find(x, y, [&](int i) {return checkCollision(world.players[i].getCollider(), box);});
+		if(player >= 0) {return SWEEP_PLAYER;}
+	}
+	if(stop == TRACE_OFF_MAP) {
+		x = startX+dx;
+		y = startY+dy;
+		return SWEEP_OFF_MAP;
+	}
+	return stop == TRACE_TILE ? SWEEP_TILE : SWEEP_CLEAR;
+}
+
+bool Bullet::move(GameWorld& world) {
+	//Tested at its top left and bottom right corners, and breaks the bricks it hits
+	static const SDL_Point corners[2] = {{0, 0}, {WIDTH, HEIGHT}};
+	SDL_Point cell;
+	int player;
+	switch(sweep(world, speed*cos(PI*(dir+1)/2), speed*sin(PI*(dir+1)/2), corners, 2, cell, player)) {
+		case SWEEP_TILE:
+			world.map().hit(cell.x*Tile::WIDTH, cell.y*Tile::HEIGHT);
+			return false;
+		case SWEEP_PLAYER:
+			world.players[player].life--;
+			world.record(EVENT_HIT, player, x, y, HIT_BULLET);
+			return false;
+		case SWEEP_OFF_MAP:
+			return false;
+	}
+	return true;
+}
+
+bool Bullet::move(GameWorld& world, Uint32 t) {
+	//Tested at its centre, and stopped by bricks and steel without breaking them; they fly over water like the players' bullets
+	static const SDL_Point centre[1] = {{WIDTH/2, HEIGHT/2}};
+	SDL_Point cell;
+	int player;
+	switch(sweep(world, speed*cos(dir%4*PI/2), speed*sin(dir%4*PI/2), centre, 1, cell, player)) {
+		case SWEEP_TILE: case SWEEP_OFF_MAP:
+			return false;
+		case SWEEP_PLAYER:
+			world.players[player].life--;
+			world.record(EVENT_HIT, player, x, y, HIT_ENEMY_BULLET);
+			return false;
+	}
+	return onField();
+}
+
+bool Bullet::onField() {
+	return x+WIDTH/2 >= 0 && x+WIDTH/2 < SCREEN_WIDTH && y+HEIGHT/2 >= 0 && y+HEIGHT/2 < PLAYFIELD_HEIGHT;
+}
+
+void Bullet::render() {
+	gRenderQueue.pushRect(LAYER_BULLETS, {0x00, 0x00, 0x00, 0xFF}, {(int) x, (int) y, WIDTH, HEIGHT});
+}
+
+bool Bullet::blanks(GameWorld& world) {
+    SDL_Rect bullet{(int) x, (int) y, WIDTH, HEIGHT};
+    int shielded = world.playerGrid.find(x, y, [&](int i) {return checkCollision(world.players[i].getCollider(), bullet) && world.players[i].shieldEnable;});
+    if(shielded >= 0) {
+        world.players[shielded].life++;
+    }
+    return false;
+}
+
+Circle& Bomb::getCollider() {
+	return collider;
+}
+
+void Bomb::render() {
+    gRenderQueue.push(LAYER_ITEMS, &gBombTexture, {bombPosX+Player::WIDTH-(bombPosX+Player::WIDTH)%Tile::WIDTH+Tile::WIDTH/2-gBombTexture.getWidth()/2,
+        bombPosY+Player::HEIGHT-(bombPosY+Player::HEIGHT)%Tile::HEIGHT+Tile::HEIGHT/2-gBombTexture.getLength()/2, gBombTexture.getWidth(), gBombTexture.getLength()});
+}
+
+void Bomb::renderExplosion() {
+    gRenderQueue.push(LAYER_EFFECTS, &gExplosionTexture, {bombPosX+Player::WIDTH-(bombPosX+Player::WIDTH)%Tile::WIDTH+Tile::WIDTH/2-gExplosionTexture.getWidth()/2,
+        bombPosY+Player::HEIGHT-(bombPosY+Player::HEIGHT)%Tile::HEIGHT+Tile::HEIGHT/2-gExplosionTexture.getLength()/2, gExplosionTexture.getWidth(), gExplosionTexture.getLength()});
+}
+
+void Bomb::blowUp(GameWorld& world, int x, int y) {
+    //Bricks in reach turn to grass (and become spawnable)
+    for(int i = 1; i<=scope; i++) {
+        world.map().hit(x+Tile::WIDTH*i, y);//right
+        world.map().hit(x-Tile::WIDTH*i, y);//left
+        world.map().hit(x, y-Tile::HEIGHT*i);//up
+        world.map().hit(x, y+Tile::HEIGHT*i);//down
+    }
+    for(int i = 0; i < world.players.size(); i++) {
+    	if( (world.players[i].playerRect.x < x && world.players[i].playerRect.x > x-Tile::WIDTH*scope && (world.players[i].playerRect.y > y || world.players[i].playerRect.y < y+Tile::HEIGHT*scope)) //player on the left
+    		|| (world.players[i].playerRect.x > x + Tile::WIDTH && world.players[i].playerRect.x < x+Tile::WIDTH + (Tile::WIDTH*scope) && (world.players[i].playerRect.y > y || world.players[i].playerRect.y < y+Tile::HEIGHT*scope)) //player on the right
+    		|| (world.players[i].playerRect.y < y && world.players[i].playerRect.y > y-Tile::WIDTH*scope && (world.players[i].playerRect.x > x || world.players[i].playerRect.x < x+Tile::WIDTH*scope))//player on top
+    		|| (world.players[i].playerRect.y > y + Tile::HEIGHT && world.players[i].playerRect.y < y+Tile::HEIGHT+(Tile::HEIGHT*scope) && (world.players[i].playerRect.x > x || world.players[i].playerRect.x < x+Tile::WIDTH*scope))//player on bottom
+    		|| world.checkBombCollide(world.players[i].getCollider())//player on bomb
+    		) {
+    		world.players[i].life--;
+    		world.record(EVENT_HIT, i, world.players[i].playerRect.x, world.players[i].playerRect.y, HIT_BOMB);
+    	}
+    }
+}
+
+Enemy::Enemy(GameWorld& world, int wave):
+	wave(wave) {
+	SDL_Point cell = world.spawnPoint();
+	posX = cell.x + WIDTH/2;
+	posY = cell.y + HEIGHT/2;
+
+	//random path
+	path = world.rng()%3;
+	if(world.rng()%2 == 1){initDir = true;}
+	else{initDir = false;}
+
+	//random velocities
+	vx = world.rng()%2-1;
+	vy = world.rng()%2-1;
+	if(vx==0||vy==0) {vx = 1; vy = 1;}
+
+	angle = 0;
+	collider = {posX, posY, WIDTH/2};
+	collisionReady = true;
+}
+
+void Enemy::shoot(GameWorld& world) {
+	if(world.enemyBullets.spawn(posX+WIDTH/2-1, posY+HEIGHT/2-1, angle) == NULL) {
+		++world.enemyBulletsRefused;
+	}
+}
+
+void Enemy::move(GameWorld& world) {
+	switch(path) {
+		//Linear movement
+		case 0:
+			posX+=vx;
+			if(posX < 0 || posX+WIDTH > SCREEN_WIDTH ) {vx = -1*vx;}
+			posY+=vy;
+			if(posY < 0 || posY+HEIGHT > SCREEN_HEIGHT-SCOREBOARD_HEIGHT) {vy = -1*vy;}
+			shiftColliders();
+			break;
+		//Circular
+/*		case 1:
+			posX += 5*cos(PI*t/1000);
+			posY += 5*sin(PI*t/1000);
+			shiftColliders();
+			break;*/
+		//Searcher
+		case 1:
+			if(initDir){posX += vx;}
+			else{posX -= vx;}
+			if(world.map().tile(posX+WIDTH, posY)->getWalkability() > 0) {posY+=vy;}
+			else {posX += vx;}
+			if(world.map().tile(posX+WIDTH, posY+HEIGHT)->getWalkability() > 0) {posX-=vx;}
+			else {posY+=vy;}
+			if(world.map().tile(posX, posY+HEIGHT)->getWalkability() > 0) {posY-=vy;}
+			else {posX-=vx;}
+			if(world.map().tile(posX, posY)->getWalkability() > 0) {posX+=vx;}
+			else{posY-=vy;}
+			if(posX==0||posX+WIDTH==SCREEN_WIDTH){vx=-1*vx;};
+			if(posY==0||posY+HEIGHT==PLAYFIELD_HEIGHT){vy=-1*vy;};
+
+			shiftColliders();
+			break;
+		//Static
+		case 2:
+			if(world.frame % 10 ==0) {shoot(world);}
+	}
+	//Spin (the static enemy shoots where it faces)
+	angle++;
+	hit(world);
+}
+
+void Enemy::shiftColliders() {
+	collider.x = posX+collider.r;
+	collider.y = posY+collider.r;
+}
+
+Circle& Enemy::getCollider() {
+	return collider;
+}
+
+void Enemy::hit(GameWorld& world) {
+	for(int i = 0; i < world.players.size(); i++) {
+		if(checkCollision(world.players[i].getCollider(), collider)) {
+			if(collisionReady){
+				if(!world.players[i].shieldEnable) {
+					world.players[i].life--;
+					world.record(EVENT_HIT, i, posX, posY, HIT_ENEMY);
+				}
+				vx = -1*vx;
+				vy = -1*vy;
+			}
+			collisionReady = false;	
+		}
+		else {collisionReady = true;}
+	}
+}
+
+void Enemy::render() {
+	gRenderQueue.push(LAYER_ENEMIES, &gEnemyTexture, {posX, posY, gEnemyTexture.getWidth(), gEnemyTexture.getLength()}, NULL, angle);
+}
+
+void KeyboardController::keyEvent(Uint32 timestamp, SDL_Scancode key, bool down) {
+	for(int i = UP; i <= PLACEBOMB; ++i) {
+		if(key == con[i]) {
+			KeyEvent event = {timestamp, (Uint8) (1<<i), down};
+			//Queue full (long pause): the oldest event can't wait any longer
+			if(queueLength == QUEUE_SIZE) {
+				apply(queue[queueStart]);
+				queueStart = (queueStart+1)%QUEUE_SIZE;
+				--queueLength;
+			}
+			queue[(queueStart+queueLength)%QUEUE_SIZE] = event;
+			++queueLength;
+		}
+	}
+}
+
+void KeyboardController::setTickEnd(Uint32 time) {
+	tickEnd = time;
+}
+
+void KeyboardController::apply(const KeyEvent& event) {
+	if(event.down) {
+		held |= event.bit;
+		pressed |= event.bit;
+	} else {
+		held &= ~event.bit;
+	}
+}
+
+Uint8 KeyboardController::next(GameWorld& world, int player) {
+	//Everything that happened up to the end of this tick; later events wait for their own tick
+	while(queueLength > 0 && (Sint32) (queue[queueStart].timestamp-tickEnd) <= 0) {
+		apply(queue[queueStart]);
+		queueStart = (queueStart+1)%QUEUE_SIZE;
+		--queueLength;
+	}
+
+	//Directions count while held, or for one tick if tapped in between; SHOOT and PLACEBOMB are presses only
+	Uint8 directions = (1<<UP) | (1<<LEFT) | (1<<DOWN) | (1<<RIGHT);
+	Uint8 input = (held & directions) | pressed;
+	pressed = 0;
+	return input;
+}
+
+Uint8 ReplayController::next(GameWorld& world, int player) {
+	if(position < inputs.size()) {
+		return inputs[position++];
+	}
+	return 0;
+}
+
+Uint8 BotController::next(GameWorld& world, int player) {
+	Player& me = world.players[player];
+	int x = me.playerRect.x, y = me.playerRect.y;
+
+	//The nearest other player is the opponent
+	int nearest = -1, nearestDistance = 0;
+	for(int i = 0; i < world.players.size(); ++i) {
+		int distance = abs(world.players[i].playerRect.x-x)+abs(world.players[i].playerRect.y-y);
+		if(i != player && (nearest < 0 || distance < nearestDistance)) {
+			nearest = i;
+			nearestDistance = distance;
+		}
+	}
+	Player& foe = world.players[nearest];
+	Uint8 input = 0;
+
+	//Didn't get anywhere last tick: sidestep in a random direction for a while
+	if(x == lastX && y == lastY && facing != 0 && detourTicks == 0) {
+		detourTicks = 15+rng()%30;
+		detour = 1<<(rng()%4);
+	}
+	lastX = x;
+	lastY = y;
+
+	//Head for the nearest power up on the field, otherwise for the opponent
+	int targetX = foe.playerRect.x, targetY = foe.playerRect.y;
+	if(world.powerUps.size() > 0) {
+		int best = -1;
+		for(int i = 0; i < world.powerUps.size(); ++i) {
+			int distance = abs(world.powerUps[i].powerUpRect.x-x)+abs(world.powerUps[i].powerUpRect.y-y);
+			if(best < 0 || distance < best) {
+				best = distance;
+				targetX = world.powerUps[i].powerUpRect.x;
+				targetY = world.powerUps[i].powerUpRect.y;
+			}
+		}
+	}
+	int dx = targetX-x, dy = targetY-y;
+
+	if(detourTicks > 0) {
+		--detourTicks;
+		input = detour;
+	} else if(abs(dx) > abs(dy)) {
+		input = dx > 0 ? 1<<RIGHT : 1<<LEFT;
+	} else if(dy != 0) {
+		input = dy > 0 ? 1<<DOWN : 1<<UP;
+	}
+
+	//Opponent in line: turn to face them, and fire once facing
+	int fx = foe.playerRect.x-x, fy = foe.playerRect.y-y;
+	Uint8 aim = 0;
+	if(abs(fy) < Player::HEIGHT/2) {aim = fx > 0 ? 1<<RIGHT : 1<<LEFT;}
+	else if(abs(fx) < Player::WIDTH/2) {aim = fy > 0 ? 1<<DOWN : 1<<UP;}
+	if(shootCooldown > 0) {--shootCooldown;}
+	if(aim != 0) {
+		input = aim;
+		if(facing == aim && shootCooldown == 0) {
+			input |= 1<<SHOOT;
+			shootCooldown = TICK_RATE/4;
+		}
+	}
+
+	//Drop a bomb when the opponent is close
+	if(me.bombEnable && abs(fx)+abs(fy) < 2*Tile::WIDTH && rng()%TICK_RATE == 0) {
+		input |= 1<<PLACEBOMB;
+	}
+
+	facing = input & ((1<<UP) | (1<<LEFT) | (1<<DOWN) | (1<<RIGHT));
+	return input;
+}
+
+Uint32 Rng::operator()() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+bool GameWorld::checkBombCollide(Circle& player) {
+	for(int i = 0; i < bombs.size(); i++) {
+        if(!checkCollision(player, bombs[i].getCollider())) {
+        	bombs[i].start = true;
+        }
+        if(checkCollision(player, bombs[i].getCollider()) && bombs[i].start) {
+        	return true;
+        }
+    }
+    return false;
+}
+
+bool GameWorld::checkEnemyCollide(Circle& player, int* life, bool collisionReady) {
+	for(int i = 0; i < enemies.size(); i++) {
+        if(checkCollision(player, enemies[i].getCollider())) {
+        	if(collisionReady) {*life = *life-1;}
+        	collisionReady = false;
+        	return true;
+        }
+        else {collisionReady = true;}
+    }
+    return false;
+}
+
+void PlayerGrid::clear() {
+	memset(head, -1, sizeof(head));
+	memset(next, -1, sizeof(next));
+	memset(cellOf, -1, sizeof(cellOf));
+}
+
+void PlayerGrid::unlist(int player) {
+	if(cellOf[player] < 0) {return;}
+	Sint8* link = &head[cellOf[player]];
+	while(*link != player) {link = &next[*link];}
+	*link = next[player];
+	cellOf[player] = -1;
+}
+
+void PlayerGrid::place(int player, int x, int y) {
+	int cell = min(max(x/Tile::WIDTH, 0), Map::COLS-1)*Map::ROWS+min(max(y/Tile::HEIGHT, 0), Map::ROWS-1);
+	if(cellOf[player] == cell) {return;}
+	unlist(player);
+	next[player] = head[cell];
+	head[cell] = player;
+	cellOf[player] = cell;
+}
+
+bool checkCollision(Circle& c1, Circle& c2) {
+	if(sqrt(pow(c1.x-c2.x, 2)+pow(c1.y-c2.y, 2)) < c1.r+c2.r) {
+		return true;
+	}
+	return false;
+}
+
+bool checkCollision(Circle& c1, SDL_Rect r) {
+	//Closest point on collision box
+    int cX, cY;
+    if(c1.x < r.x) {cX = r.x;}
+    else if(c1.x > r.x + r.w) {cX = r.x + r.w;}
+    else{cX = c1.x;}
+    //Find closest y offset
+    if(c1.y < r.y) {cY = r.y;}
+    else if(c1.y > r.y + r.h) {cY = r.y + r.h;}
+    else{cY = c1.y;}
+
+    //If the closest point is inside the circle
+    if(sqrt(pow(cX-c1.x, 2)+pow(cY-c1.y, 2)) < c1.r) {
+        return true;
+    }
+    return false;
+}
+
+bool checkIfEnclosed(SDL_Rect& smallerArea, SDL_Rect& largerArea) {
+	if(smallerArea.x >= largerArea.x && smallerArea.x+smallerArea.w <= largerArea.x+largerArea.w
+	&& smallerArea.y >= largerArea.y && smallerArea.y+smallerArea.h <= largerArea.y+largerArea.h) {
+		return true;
+	} else {
+		return false;
+	}
+}
+
+static bool overlaps(SDL_Rect a, SDL_Rect b) {
+	return a.x < b.x+b.w && b.x < a.x+a.w && a.y < b.y+b.h && b.y < a.y+a.h;
+}
+
+SDL_Point GameWorld::spawnPoint() {
+	static const int TRIES = 8;
+	Map& m = map();
+	//Few cells are ever taken, so a couple of random picks nearly always find a free one
+	SDL_Point cell;
+	for(int attempt = 0; attempt < TRIES; ++attempt) {
+		cell = m.spawnCell(rng()%m.spawnCellCount());
+		SDL_Rect r = {cell.x, cell.y, Tile::WIDTH, Tile::HEIGHT};
+		bool taken = false;
+		for(int i = 0; i < players.size() && !taken; ++i) {
+			taken = overlaps(r, players[i].playerRect);
+		}
+		for(int i = 0; i < powerUps.size() && !taken; ++i) {
+			taken = overlaps(r, powerUps[i].powerUpRect);
+		}
+		for(int i = 0; i < enemies.size() && !taken; ++i) {
+			taken = overlaps(r, {enemies[i].posX, enemies[i].posY, Enemy::WIDTH, Enemy::HEIGHT});
+		}
+		for(int i = 0; i < bombs.size() && !taken; ++i) {
+			Circle& c = bombs[i].getCollider();
+			taken = overlaps(r, {c.x-c.r, c.y-c.r, 2*c.r, 2*c.r});
+		}
+		if(!taken) {break;}
+	}
+	return cell;
+}
+
+void createTiles() {
+	for(int i = 0; i < TOTAL_TILES; ++i) {
+		if(gTiles[i] == NULL) {gTiles[i] = new Tile(i);}
+	}
+}
+
+bool loadLevels(string path) {
+	//For reading the map layout
+	string contents;
+	if(!readAsset(path, contents)) {
+		return false;
+	}
+	istringstream mapReader(contents);
+	gLevelLayouts.clear();
+	for(int i = 0; i < LEVELS; ++i) {
+		gLevelLayouts.emplace_back(mapReader);
+	}
+	return true;
+}
+
+bool loadPlayerSlots(string path) {
+	string contents;
+	if(!readAsset(path, contents)) {
+		return false;
+	}
+	istringstream slotReader(contents);
+
+	//One slot per line: spawn column and row, look, then six tab separated key names; anything after # is a comment
+	gPlayerSlots.clear();
+	string line;
+	int lineNumber = 0;
+	while(getline(slotReader, line)) {
+		++lineNumber;
+		line = line.substr(0, line.find('#'));
+		istringstream fields(line);
+		PlayerSlot slot;
+		if(!(fields >> slot.col)) {continue;}	//Blank line
+		fields >> slot.row >> slot.look;
+		bool valid = !fields.fail() && slot.col >= 0 && slot.col < Map::COLS && slot.row >= 0 && slot.row < Map::ROWS
+			&& (slot.look == 1 || slot.look == 2) && gPlayerSlots.size() < MAX_PLAYERS;
+		string key;
+		getline(fields, key, '\t');	//Rest of the look's field
+		for(int i = 0; i < 6 && valid; ++i) {
+			valid = (bool) getline(fields, key, '\t');
+			key.erase(key.find_last_not_of(" \r")+1);
+			slot.keys[i] = SDL_GetScancodeFromName(key.c_str());
+			valid = valid && slot.keys[i] != SDL_SCANCODE_UNKNOWN;
+		}
+		if(!valid) {
+			ERROR_LOG(LOG_ASSETS, "Bad player slot on line %d of %s", lineNumber, path.c_str());
+			return false;
+		}
+		gPlayerSlots.push_back(slot);
+	}
+	return gPlayerSlots.size() >= 2;
+}
+
+void WaveSchedule::compile() {
+	events.clear();
+	for(int i = 0; i < waves.size(); ++i) {
+		events.push_back({waves[i].start*TICK_RATE, i, true});
+		events.push_back({(waves[i].start+waves[i].duration)*TICK_RATE, i, false});
+	}
+	//By time; a wave ending makes room before one starting on the same tick
+	sort(events.begin(), events.end(), [](const WaveEvent& a, const WaveEvent& b) {
+		if(a.tick != b.tick) {return a.tick < b.tick;}
+		if(a.spawn != b.spawn) {return !a.spawn;}
+		return a.wave < b.wave;
+	});
+
+	int powerUps = 0, enemies = 0;
+	peakPowerUps = peakEnemies = 0;
+	for(int i = 0; i < events.size(); ++i) {
+		Wave& w = waves[events[i].wave];
+		int sign = events[i].spawn ? 1 : -1;
+		for(int j = 0; j < NPOWERUPS; ++j) {
+			powerUps += sign*w.powerUps[j];
+		}
+		enemies += sign*w.enemies;
+		peakPowerUps = max(peakPowerUps, powerUps);
+		peakEnemies = max(peakEnemies, enemies);
+	}
+}
+
+bool loadWaves(string path) {
+	string contents;
+	if(!readAsset(path, contents)) {
+		return false;
+	}
+	istringstream waveReader(contents);
+
+	//A [name] line starts the next level; lines of numbers are waves; anything after # is a comment
+	gWaveSchedules.clear();
+	string line;
+	int lineNumber = 0;
+	while(getline(waveReader, line)) {
+		++lineNumber;
+		line = line.substr(0, line.find('#'));
+		if(line.find('[') != string::npos) {
+			gWaveSchedules.emplace_back();
+			continue;
+		}
+		istringstream fields(line);
+		Wave w;
+		if(!(fields >> w.start)) {continue;}	//Blank line
+		fields >> w.duration >> w.enemies;
+		for(int i = 0; i < NPOWERUPS; ++i) {
+			fields >> w.powerUps[i];
+		}
+		if(fields.fail() || gWaveSchedules.empty() || w.start < 0 || w.duration <= 0 || w.enemies < 0) {
+			ERROR_LOG(LOG_ASSETS, "Bad wave on line %d of %s", lineNumber, path.c_str());
+			return false;
+		}
+		for(int i = 0; i < NPOWERUPS; ++i) {
+			if(w.powerUps[i] < 0) {
+				ERROR_LOG(LOG_ASSETS, "Bad wave on line %d of %s", lineNumber, path.c_str());
+				return false;
+			}
+		}
+		gWaveSchedules.back().waves.push_back(w);
+	}
+
+	//Levels without a section just have no waves
+	gWaveSchedules.resize(LEVELS);
+	for(int i = 0; i < LEVELS; ++i) {
+		gWaveSchedules[i].compile();
+	}
+	return true;
+}
+
+GameWorld::GameWorld(Uint32 seed, int playerCount):
+	levels(gLevelLayouts), bullets(MAX_BULLETS), powerUps(largestWave(false)), enemies(largestWave(true)), enemyBullets(MAX_ENEMY_BULLETS), bombs(MAX_BOMBS), enemyBulletPeak(0), enemyBulletTicks(0), enemyBulletsRefused(0), hordeSize(0), explosions(MAX_BOMBS), rng{seed != 0 ? seed : 1}, frame(0), levelStart(0), waveStart(0), waveCursor(0), level(0), levelDuration(60),
+	reset(false), disableCon(false), gameOver(false), verbose(true), telemetry(NULL), match(0) {
+	//initial player values
+	bool enableBombUp = false;
+	bool enableBulletUp = false;
+	bool enableShieldUp = false;
+
+	//Create players; placePlayers puts them on their spawn cells
+	playerCount = min(playerCount, min(MAX_PLAYERS, (int) gPlayerSlots.size()));
+	players.reserve(playerCount);
+	for(int i = 0; i < playerCount; ++i) {
+		if(gPlayerSlots[i].look == 2) {
+			players.emplace_back(&gPlayerTwoTexture, &gPlayerTwoShieldTexture, 0, 0, enableBombUp, enableBulletUp, enableShieldUp);
+		} else {
+			players.emplace_back(&gPlayerOneTexture, &gPlayerOneShieldTexture, 0, 0, enableBombUp, enableBulletUp, enableShieldUp);
+		}
+	}
+	placePlayers();
+
+	//Everything a match adds to up front, so ticks don't allocate
+	impacts.reserve(MAX_IMPACTS);
+}
+
+void GameWorld::startHorde(int size) {
+	hordeSize = size;
+	horde.reserve(size);
+}
+
+void GameWorld::restart() {
+    bullets.clear();
+    enemyBullets.clear();
+    for(int i = 0; i < players.size(); i++) {
+        players[i].life = 5;
+    }
+	level = (level+1)%LEVELS;
+	placePlayers();
+    reset = false;
+
+	//The new level's waves start from the top, and its horde from scratch
+	powerUps.clear();
+	enemies.clear();
+	horde.clear();
+	waveStart = frame;
+	waveCursor = 0;
+}
+
+void GameWorld::placePlayers() {
+	playerGrid.clear();
+	for(int i = 0; i < players.size(); ++i) {
+		SDL_Point cell = map().openCell(gPlayerSlots[i].col, gPlayerSlots[i].row);
+		players[i].playerRect.x = cell.x+(Tile::WIDTH-Player::WIDTH)/2;
+		players[i].playerRect.y = cell.y+(Tile::HEIGHT-Player::HEIGHT)/2;
+		players[i].shiftColliders();
+		playerGrid.place(i, players[i].getCollider().x, players[i].getCollider().y);
+	}
+}
+
+int GameWorld::leader(int Player::* stat) {
+	int best = 0;
+	bool shared = false;
+	for(int i = 1; i < players.size(); ++i) {
+		if(players[i].*stat > players[best].*stat) {
+			best = i;
+			shared = false;
+		} else if(players[i].*stat == players[best].*stat) {
+			shared = true;
+		}
+	}
+	return shared ? -1 : best;
+}
+
+void GameWorld::attachTelemetry(TelemetryStream* stream, Uint32 matchNumber) {
+	telemetry = stream;
+	match = matchNumber;
+	record(EVENT_MATCH_START, -1, players.size(), 0, level);
+}
+
+void GameWorld::record(int type, int player, int x, int y, int value) {
+	if(telemetry == NULL) {return;}
+	TelemetryRecord r = {(Uint32) frame, match, (Uint8) type, (Sint8) player, (Sint16) x, (Sint16) y, (Sint16) value};
+	telemetry->record(r);
+}
+
+WaveSchedule& GameWorld::waves() {
+	return gWaveSchedules[level];
+}
+
+void GameWorld::startWave(int wave) {
+	//Levels walled in by bricks have nowhere to put a wave until some are broken
+	if(map().spawnCellCount() == 0) {
+		if(verbose) {DEBUG_LOG(LOG_GAME, "No room for wave %d", wave);}
+		return;
+	}
+
+	Wave& w = waves().waves[wave];
+	for(int i = 0; i < NPOWERUPS; i++) {
+		for(int j = 0; j < w.powerUps[i]; j++) {
+			powerUps.spawn(*this, i, wave);
+		}
+	}
+	//In horde mode the horde takes the place of the waves' enemies
+	for(int i = 0; i < w.enemies && hordeSize == 0; i++) {
+		enemies.spawn(*this, wave);
+	}
+}
+
+void GameWorld::endWave(int wave) {
+	for(int i = 0; i < powerUps.size();) {
+		if(powerUps[i].wave == wave) {powerUps.erase(i);}
+		else {++i;}
+	}
+	for(int i = 0; i < enemies.size();) {
+		if(enemies[i].wave == wave) {enemies.erase(i);}
+		else {++i;}
+	}
+	if(verbose) {DEBUG_LOG(LOG_GAME, "Powerups cleared");}
+}
+
+void GameWorld::tick(const Uint8* inputs) {
+	//Advance the match clock; everything below reads this one value
+	++frame;
+
+	for(int i = 0; i < players.size(); ++i) {players[i].act(*this, inputs[i]);}
+
+	//Spawn and clear the waves whose time has come; events are sorted, so only the next one needs a look
+	vector<WaveEvent>& events = waves().events;
+	while(waveCursor < events.size() && frame-waveStart >= events[waveCursor].tick) {
+		if(events[waveCursor].spawn) {startWave(events[waveCursor].wave);}
+		else {endWave(events[waveCursor].wave);}
+		++waveCursor;
+	}
+
+	//A player ran out of lives last tick: whoever has the most left scores the set, then the next one starts
+	if(reset) {
+		int winner = leader(&Player::life);
+		if(winner >= 0) {
+			players[winner].score++;
+		}
+		//-1 when the most lives are shared: nobody scores
+		record(EVENT_SET_WON, winner, 0, 0, level);
+		restart();
+		return;
+	}
+
+	for(int i = 0; i < players.size(); i++) {
+		if(players[i].life <= 0) {
+			reset = true;
+			record(EVENT_DEATH, i, players[i].playerRect.x, players[i].playerRect.y);
+		}
+	}
+
+	if(timeLeft() == 0) {
+		int winner = leader(&Player::score);
+		if(winner < 0) { //tie at the top, play on
+			levelStart = frame;
+			restart();
+		} else {
+			gameOver = true;
+			record(EVENT_MATCH_END, winner, 0, 0);
+		}
+	}
+
+	for(int i = 0; i < enemyBullets.size();) {
+		if(!enemyBullets[i].move(*this, frame) && !enemyBullets[i].blanks(*this)) {
+			//Bullets that flew off the field just go
+			if(impacts.size() < MAX_IMPACTS && enemyBullets[i].onField()) {impacts.push_back({(int) enemyBullets[i].x, (int) enemyBullets[i].y});}
+			enemyBullets.erase(i);
+		} else {
+			++i;
+		}
+	}
+	enemyBulletPeak = max(enemyBulletPeak, enemyBullets.size());
+	enemyBulletTicks += enemyBullets.size();
+
+	for(int i = 0; i < enemies.size(); i++) {
+		enemies[i].move(*this);
+	}
+
+	//The horde comes back whole each set, as soon as the level has room for it
+	if(horde.size() < hordeSize && map().spawnCellCount() > 0) {
+		horde.spawn(*this, hordeSize-horde.size());
+	}
+	horde.update(*this);
+
+	for(int i = 0; i < bullets.size();) {
+		if(!bullets[i].move(*this) && !bullets[i].blanks(*this)) {
+			if(impacts.size() < MAX_IMPACTS) {impacts.push_back({(int) bullets[i].x, (int) bullets[i].y});}
+			bullets.erase(i);
+		} else {
+			++i;
+		}
+	}
+
+	for(int i = 0; i<bombs.size();) {
+		if(secondsSince(bombs[i].placedAt) > Bomb::TIMER) {
+			bombs[i].blowUp(*this, bombs[i].bombPosX, bombs[i].bombPosY);
+			record(EVENT_DETONATION, -1, bombs[i].getCollider().x, bombs[i].getCollider().y);
+			explosions.spawn(bombs[i]);
+			bombs.erase(i);
+		} else {
+			++i;
+		}
+	}
+
+	for(int i = 0; i < players.size(); i++) {
+		if(players[i].shieldEnable == true && secondsSince(players[i].shieldStart)>Player::SHIELD_DURATION) {
+			players[i].shieldEnable = false;
+		}
+		if(players[i].bombEnable == true && secondsSince(players[i].bombStart)>Player::BOMB_DURATION) {
+			players[i].bombEnable = false;
+		}
+		for(int j = 0; j < powerUps.size();) {
+			if(checkCollision(players[i].getCollider(), powerUps[j].getCollider())) {
+				players[i].activatePowerUp(*this, powerUps[j].getPowerUpID());
+				powerUps.erase(j);
+			} else {
+				++j;
+			}
+		}
+	}
+}
+
+static const Uint32 SNAPSHOT_MAGIC = 0x534D4E42;	//"BMNS"
+static const Uint32 SNAPSHOT_LAYOUT = sizeof(Bullet) | sizeof(Enemy) << 8 | sizeof(Bomb) << 16 | sizeof(PowerUp) << 24;
+
+void GameWorld::snapshot(Snapshot& s) {
+	s.clear();
+	s.put(SNAPSHOT_MAGIC);
+	s.put(SNAPSHOT_LAYOUT);
+
+	s.put(frame);
+	s.put(levelStart);
+	s.put(waveStart);
+	s.put(waveCursor);
+	s.put(rng.state);
+	s.put(level);
+	s.put(reset);
+	s.put(gameOver);
+
+	//Tiles as type numbers, each level followed by its spawnable cells
+	s.put((Uint32) levels.size());
+	for(int l = 0; l < levels.size(); ++l) {
+		Uint8 tiles[Map::COLS*Map::ROWS];
+		for(int i = 0; i < Map::COLS; ++i) {
+			for(int j = 0; j < Map::ROWS; ++j) {
+				tiles[i*Map::ROWS+j] = levels[l].tileMap[i][j]->getTileType();
+			}
+		}
+		s.write(tiles, sizeof(tiles));
+		levels[l].saveSpawnCells(s);
+	}
+
+	s.put((Uint32) players.size());
+	for(int i = 0; i < players.size(); ++i) {
+		players[i].save(s);
+	}
+
+	s.putArray(powerUps.items);
+	s.putArray(bullets.items);
+	s.putArray(enemyBullets.items);
+	s.putArray(enemies.items);
+	s.putArray(bombs.items);
+	horde.save(s);
+}
+
+bool GameWorld::restore(Snapshot& s) {
+	Uint32 magic, layout, count;
+	s.rewind();
+	if(!s.get(magic) || magic != SNAPSHOT_MAGIC || !s.get(layout) || layout != SNAPSHOT_LAYOUT) {
+		return false;
+	}
+
+	s.get(frame);
+	s.get(levelStart);
+	s.get(waveStart);
+	s.get(waveCursor);
+	s.get(rng.state);
+	s.get(level);
+	s.get(reset);
+	s.get(gameOver);
+
+	if(!s.get(count) || count != levels.size()) {return false;}
+	for(int l = 0; l < levels.size(); ++l) {
+		Uint8 tiles[Map::COLS*Map::ROWS];
+		if(!s.read(tiles, sizeof(tiles))) {return false;}
+		for(int i = 0; i < Map::COLS; ++i) {
+			for(int j = 0; j < Map::ROWS; ++j) {
+				Uint8 tileType = tiles[i*Map::ROWS+j];
+				levels[l].tileMap[i][j] = gTiles[tileType < TOTAL_TILES ? tileType : GRASS];
+			}
+		}
+		if(!levels[l].loadSpawnCells(s)) {return false;}
+	}
+
+	if(!s.get(count) || count != players.size()) {return false;}
+	playerGrid.clear();
+	for(int i = 0; i < players.size(); ++i) {
+		if(!players[i].load(s)) {return false;}
+		playerGrid.place(i, players[i].getCollider().x, players[i].getCollider().y);
+	}
+
+	if(!s.getArray(powerUps.items)) {return false;}
+	for(int i = 0; i < powerUps.size(); ++i) {
+		if(powerUps[i].id < 0 || powerUps[i].id >= NPOWERUPS) {return false;}
+	}
+
+	return s.getArray(bullets.items) && s.getArray(enemyBullets.items) && s.getArray(enemies.items) && s.getArray(bombs.items) && horde.load(s);
+}
+
+Uint32 GameWorld::checksum() {
+	//FNV-1a over the parts of the state that matter for a desync
+	Uint32 hash = 2166136261u;
+	auto mix = [&hash](int value) {hash = (hash^(Uint32) value)*16777619u;};
+
+	mix(frame);
+	mix(level);
+	mix(rng.state);
+	mix(waveCursor);
+	mix(reset);
+	mix(gameOver);
+	for(int i = 0; i < players.size(); ++i) {
+		mix(players[i].playerRect.x);
+		mix(players[i].playerRect.y);
+		mix(players[i].life);
+		mix(players[i].score);
+		mix(players[i].vel);
+		mix(players[i].shieldEnable);
+		mix(players[i].bombEnable);
+		mix(players[i].bulletUpEnable);
+	}
+	for(int i = 0; i < bullets.size(); ++i) {mix(bullets[i].x); mix(bullets[i].y);}
+	for(int i = 0; i < enemyBullets.size(); ++i) {mix(enemyBullets[i].x); mix(enemyBullets[i].y);}
+	for(int i = 0; i < enemies.size(); ++i) {mix(enemies[i].posX); mix(enemies[i].posY);}
+	for(int i = 0; i < powerUps.size(); ++i) {mix(powerUps[i].id);}
+	for(int i = 0; i < bombs.size(); ++i) {mix(bombs[i].bombPosX); mix(bombs[i].bombPosY);}
+	for(int i = 0; i < horde.size(); ++i) {mix(horde.x[i]); mix(horde.y[i]);}
+	for(int i = 0; i < Map::COLS; ++i) {
+		for(int j = 0; j < Map::ROWS; ++j) {
+			mix(map().tileMap[i][j]->getTileType());
+		}
+	}
+	return hash;
+}
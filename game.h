@@ -0,0 +1,813 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define PI 3.14159265
+
+using namespace std;	//FINALLY!!! <3
+
+//Screen dimension constants
+const int SCOREBOARD_HEIGHT = 60;
+const int PLAYFIELD_HEIGHT = 540;
+
+const int SCREEN_WIDTH = 1170;
+const int SCREEN_HEIGHT = SCOREBOARD_HEIGHT+PLAYFIELD_HEIGHT;
+
+//Game logic runs in fixed steps of this rate, independent of the display
+const int TICK_RATE = 60;
+
+//Number of levels to be created (Now 3)
+const int LEVELS = 3;
+
+//Players a match can have; players.txt has a slot for each
+const int MAX_PLAYERS = 8;
+
+//Power ups variables
+static const int NPOWERUPS = 5;
+
+enum Tiles{
+	GRASS, BRICK, WATER, STEEL, SLIDE_DOWN, SLIDE_LEFT, SLIDE_UP, SLIDE_RIGHT, TOTAL_TILES
+};
+
+enum Directions{
+	SOUTH, WEST, NORTH, EAST, TOTAL_DIRECTIONS
+};
+
+enum Controls{
+	UP, LEFT, DOWN, RIGHT, SHOOT, PLACEBOMB
+};
+
+enum PowerUps{
+	LIFE, BOMB, SHIELD, BULLETUPGRADE, SPEEDUP
+};
+
+struct Circle{
+		int x, y;
+		int r;
+};
+
+//Xorshift random number generator; seeded so both ends of a network match roll the same numbers
+struct Rng{
+		Uint32 state;
+		Uint32 operator()();
+};
+
+class Snapshot;
+class GameWorld;
+class TelemetryStream;
+
+class LTexture{
+   		//The actual hardware texture
+		SDL_Texture* mTexture;
+
+		//Image dimensions
+		int mWidth;
+		int mLength;
+
+		//Small number unique to this texture, for sorting draws by texture
+		int mId;
+
+	public:
+		//Initialize variables
+		LTexture();
+
+		//Deallocates memory
+		~LTexture();
+
+		//Owns its SDL texture, so copies would free it twice; entities keep LTexture* instead
+		LTexture(const LTexture&) = delete;
+		LTexture& operator=(const LTexture&) = delete;
+
+		//Loads image at specified path
+		bool loadFromFile(const string&);
+
+		#ifdef _SDL_TTF_H
+		//Creates image from font string
+		bool loadFromRenderedText(const char*, SDL_Color);
+		#endif
+
+		//Deallocates texture
+		void free();
+
+		//Set color modulation
+		void setColor(Uint8, Uint8, Uint8);
+
+		//Set blending
+		void setBlendMode(SDL_BlendMode);
+
+		//Set alpha modulation
+		void setAlpha(Uint8 alpha);
+
+		//Renders texture at given point
+		void render(SDL_Rect*, SDL_Rect* = NULL, double = 0.0, SDL_Point* = NULL, SDL_RendererFlip = SDL_FLIP_NONE);
+		void render(int, int, SDL_Rect* = NULL, double = 0.0, SDL_Point* = NULL, SDL_RendererFlip = SDL_FLIP_NONE);
+
+		//Gets image dimensions
+		int getWidth();
+		int getLength();
+
+		int getId();
+};
+
+//What a tile type is and does, fixed at compile time
+struct TileTraits{
+		int walkability;	//The level of mobility a player needs to have to traverse the tile
+		bool breakable;	//Bombs and bullets turn it to grass
+		bool slide;	//Carries players along the way it faces
+		int direction;	//Determines the rotation of the tile/where the tile is facing
+		int frames;	//Animation frames, side by side in the sprite sheet from srcX, srcY
+		int srcX, srcY;
+};
+
+constexpr TileTraits TILE_TRAITS[TOTAL_TILES] = {
+	{0, false, false, SOUTH, 1, 0, 0},	//GRASS
+	{2, true, false, SOUTH, 1, 32, 0},	//BRICK
+	{1, false, false, SOUTH, 1, 64, 0},	//WATER
+	{3, false, false, SOUTH, 1, 96, 0},	//STEEL
+	{0, false, true, SOUTH, 4, 0, 32},	//SLIDE_DOWN
+	{0, false, true, WEST, 4, 0, 32},	//SLIDE_LEFT
+	{0, false, true, NORTH, 4, 0, 32},	//SLIDE_UP
+	{0, false, true, EAST, 4, 0, 32}	//SLIDE_RIGHT
+};
+
+//Tile predicates, each a test on the traits; TileSet turns one into a bit per tile type at compile time
+struct Blocking{static constexpr bool test(const TileTraits& t) {return t.walkability > 0;}};
+struct Breakable{static constexpr bool test(const TileTraits& t) {return t.breakable;}};
+struct Slide{static constexpr bool test(const TileTraits& t) {return t.slide;}};
+struct Permanent{static constexpr bool test(const TileTraits& t) {return t.walkability > 0 && !t.breakable;}};	//Walls for good
+
+template<class Predicate> constexpr Uint32 tileMask(int type = 0) {
+	return type == TOTAL_TILES ? 0 : (Predicate::test(TILE_TRAITS[type]) ? 1u<<type : 0) | tileMask<Predicate>(type+1);
+}
+
+//The tile types a predicate holds for, so asking about one is a shift and a mask instead of comparisons
+template<class Predicate> struct TileSet{
+		static constexpr Uint32 MASK = tileMask<Predicate>();
+		static bool has(int type) {return MASK>>type & 1;}
+};
+
+class Tile{
+		int tileType;	//Used to determine the reaction of the tile; its traits are TILE_TRAITS[tileType]
+
+	public:
+		static const int HEIGHT = 30, WIDTH = 30;
+
+		Tile(int tileType):
+			tileType(tileType) {};
+
+		int getTileType();
+		int getWalkability();
+		int getDirection();
+		int getFrames();	//Animation frames; one for all but the SLIDE tiles
+		SDL_Rect getRenderSrc(int frame);	//Sprite sheet area shown at the given tick
+		void render(int, SDL_Rect);
+};
+
+//What Map::trace ran into first
+enum TraceResults{
+	TRACE_CLEAR, TRACE_TILE, TRACE_OFF_MAP
+};
+
+class Map{
+		SDL_Rect t;
+
+ 	public:
+		static const int ROWS = PLAYFIELD_HEIGHT/Tile::HEIGHT, COLS = SCREEN_WIDTH/Tile::WIDTH;
+		static const int SPAWN_MARGIN = 4;	//Cells from the edge kept clear of spawns, so nothing lands on a starting corner
+
+		//Reads the next [name] and its tiles from a maps file
+		Map(istream&);
+
+		Tile* tileMap[COLS][ROWS];
+
+		Tile* tile(int, int);
+		void hit(int, int);
+
+		//Follows the segment from (x0, y0) to (x1, y1) through the grid one cell at a time (Amanatides-Woo), so the
+		//cost is the number of cells crossed however long it is. Finds the first cell whose tile type is in tileMask
+		//(bits 1<<BRICK and so on), or where the segment leaves the map, and how far along that is, 0 to 1.
+		//Returns a TraceResults
+		int trace(double x0, double y0, double x1, double y1, int tileMask, SDL_Point& cell, double& t);
+
+		//How far a box can go of the move asked for before it runs into an unwalkable tile or the edge of the map:
+		//along x first, then along y from there. Reads only the cells the box's leading edges sweep, and stops
+		//the box flush against whatever it meets
+		SDL_Point sweep(const SDL_Rect& box, SDL_Point move);
+		void render(int);
+
+		//Top left corner of the walkable cell nearest the given one, in pixels; bricks there are broken
+		//so a player can start on it
+		SDL_Point openCell(int col, int row);
+
+		//Spawnable cells; spawnCell gives the top left corner of one in pixels
+		int spawnCellCount() {return spawnCount;}
+		SDL_Point spawnCell(int i);
+
+		//Writes/reads the spawnable cells in their list order, so random picks match after a restore
+		void saveSpawnCells(Snapshot&);
+		bool loadSpawnCells(Snapshot&);
+
+	private:
+		//Grass cells waves can spawn on, kept up to date as bricks break. spawnCells lists them in no
+		//particular order and spawnSlot gives each cell's place in that list (-1 if it isn't spawnable),
+		//so adding a cell and picking a random one are O(1)
+		Sint16 spawnCells[COLS*ROWS];
+		Sint16 spawnSlot[COLS*ROWS];
+		int spawnCount;
+
+		void addSpawnCell(int col, int row);
+
+		//Unwalkable, or off the map
+		bool blocks(int col, int row);
+
+		//One axis of sweep: a box from pos to pos+size-1 moving d along it, spanning across to across+acrossSize-1
+		//on the other axis
+		int sweepAxis(int pos, int size, int d, int across, int acrossSize, bool vertical);
+
+		//Rebuilds the spawnable cells from the tiles
+		void findSpawnCells();
+};
+
+//What ended a bullet's sweep
+enum SweepResults{
+	SWEEP_CLEAR, SWEEP_TILE, SWEEP_PLAYER, SWEEP_OFF_MAP
+};
+
+class Bullet{
+	public:
+		static const int HEIGHT = 5, WIDTH = 5, VEL = 5;
+		static const int STOPPED_BY = 1<<BRICK | 1<<STEEL;	//Tiles no bullet passes
+		double x, y, w, h;
+		double speed;	//Pixels per tick; any speed is safe, tiles and players are swept, not sampled
+
+		int dir;
+		SDL_Rect bullet;
+
+		Bullet(double xStart, double yStart, int direction, double bulletSpeed = VEL):
+			x(xStart), y(yStart), w(WIDTH), h(HEIGHT), speed(bulletSpeed), dir(direction) {};
+
+		//Moves by (dx, dy) unless something is in the way: a tile in STOPPED_BY under one of the corners (offsets from
+		//x, y) traced through the grid, or a player. Stops where it met it; cell or player says what it was.
+		//A corner leaving the map stops nothing: the bullet moves all the way and SWEEP_OFF_MAP says it is gone
+		int sweep(GameWorld&, double dx, double dy, const SDL_Point* corners, int cornerCount, SDL_Point& cell, int& player);
+
+		bool move(GameWorld&);
+		//Enemy bullets: false once one hits a player or a wall or leaves the playfield
+		bool move(GameWorld&, Uint32 t);
+		bool onField();	//Whether its centre is over the playfield
+		void render();
+		bool blanks(GameWorld&);
+};
+
+class Player{
+
+	int dir;
+	LTexture* playerTex;
+	LTexture* shieldTex;	//Shown instead while the shield is up
+	LTexture* playerLifeTex;
+	Circle collider;
+	bool wasPreviouslyOnSlidewalk;	//Used to check entry and exit of SLIDE tile
+	SDL_Rect lastEnteredSlidewalk;
+
+	void react(GameWorld&);
+	bool touchesPlayer(GameWorld&);	//Overlaps any other player
+
+	public:
+		static const int WIDTH = 20, HEIGHT = 20;
+		static const int SHIELD_DURATION = 10;
+		static const int BOMB_DURATION = 50;
+		SDL_Rect playerRect;
+
+		int score = 0;
+		int life = 5;
+		int vel = 2;
+        bool shieldEnable;
+        bool bulletUpEnable;
+    	bool bombEnable;
+    	bool collisionReady;
+        int shieldStart;	//Ticks the power ups were picked up at
+        int bombStart;
+
+		//Power ups picked up, by id; for match statistics
+		int pickups[NPOWERUPS];
+
+		Player(LTexture* texture, LTexture* shieldTexture, int x, int y, bool enableBombUp, bool enableBulletUp, bool enableShieldUp):
+			playerRect{x, y, WIDTH, HEIGHT},
+			dir(SOUTH), playerTex(texture), shieldTex(shieldTexture), collider{x+WIDTH/2,y+WIDTH/2,WIDTH/2}, bombEnable(enableBombUp), bulletUpEnable(enableBulletUp), shieldEnable(enableShieldUp), collisionReady(true),
+			wasPreviouslyOnSlidewalk(false), lastEnteredSlidewalk{0, 0, 0, 0}, shieldStart(0), bombStart(0), pickups{} {};
+
+		//Input bits: held directions use (1<<UP) etc., SHOOT and PLACEBOMB bits are presses
+		void act(GameWorld&, Uint8);
+		void move(GameWorld&, int, int);
+
+		Circle& getCollider();
+		void shiftColliders();
+		LTexture* getTexture();	//As the player looks right now
+		void render();
+		void renderLifeTexture(int x, int y);
+		void activatePowerUp(GameWorld&, int id);
+		void placeBomb(GameWorld&);
+		void shoot(GameWorld&);
+
+		//Writes/reads everything but the textures and key bindings
+		void save(Snapshot&);
+		bool load(Snapshot&);
+
+};
+
+class PowerUp{
+ 	public:
+ 		static const int WIDTH = 20, HEIGHT = 20;
+	 	int id;	//Also picks the texture from powerUpsTex, so power ups own nothing and copy as plain data
+	 	int wave;	//Index of the wave that spawned it, in the level's schedule
+		Circle collider;
+
+		//Rect is changed to public
+	    SDL_Rect powerUpRect;
+		PowerUp(GameWorld&, int pwrUp_id, int wave);
+
+		void render();
+		Circle& getCollider();
+		int getPowerUpID();
+};
+
+class Bomb{
+		Circle collider;
+
+    public:
+        static const int WIDTH = 20, HEIGHT = 20;
+        static const int TIMER = 3;
+
+        int placedAt;	//Tick the bomb was placed at
+        int bombPosX, bombPosY;
+        int scope;
+        bool start;
+
+        Bomb(int x, int y, int tick):
+            placedAt(tick), bombPosX(x), bombPosY(y), collider{x+Player::WIDTH-(x+Player::WIDTH)%Tile::WIDTH+Tile::WIDTH/2, y+Player::HEIGHT-(y+Player::HEIGHT)%Tile::HEIGHT+Tile::HEIGHT/2, WIDTH/2}, scope(1), start(false) {};
+        Circle& getCollider();
+		void shiftColliders();
+        void render();
+        void renderExplosion();
+        void blowUp(GameWorld&, int x, int y);
+};
+
+class Enemy{
+		Circle collider;
+
+	public:
+		static const int WIDTH = 16, HEIGHT = 16;
+		int posX, posY, angle, vx, vy, path;
+		int wave;	//Index of the wave that spawned it, in the level's schedule
+		bool initDir;
+
+		Enemy(GameWorld&, int wave);
+		Circle& getCollider();
+		void shiftColliders();
+		void shoot(GameWorld&);
+		void move(GameWorld&);
+		//Flag for enemy - player collision
+		bool collisionReady;
+		void hit(GameWorld&);
+		void render();
+};
+
+//One line of the waves file: what appears, when, and for how long
+struct Wave{
+		int start;	//Seconds after the level starts
+		int duration;	//Seconds on the field before whatever is left is cleared
+		int enemies;
+		int powerUps[NPOWERUPS];	//How many of each, by id
+};
+
+//A wave appearing or being cleared, in ticks after the level starts
+struct WaveEvent{
+		int tick;
+		int wave;
+		bool spawn;
+};
+
+//The waves of one level, read from a [name] section of the waves file and compiled into events sorted by time,
+//so the game only ever looks at the next one
+class WaveSchedule{
+	public:
+		vector<Wave> waves;
+		vector<WaveEvent> events;
+
+		//Most power ups and enemies on the field at once, counting overlapping waves
+		int peakPowerUps, peakEnemies;
+
+		WaveSchedule(): peakPowerUps(0), peakEnemies(0) {};
+
+		//Builds the events from waves
+		void compile();
+};
+
+//Flat, pointer-free image of a whole match, written by snapshot() and read back by restore().
+//Clearing it keeps its capacity, so taking snapshots in a loop doesn't allocate once it has grown.
+class Snapshot{
+		vector<Uint8> bytes;
+		int readPos;
+
+	public:
+		Snapshot(): readPos(0) {};
+
+		void clear() {bytes.clear(); readPos = 0;}
+		void rewind() {readPos = 0;}
+		int size() {return bytes.size();}
+
+		void write(const void* data, int length) {
+			const Uint8* p = (const Uint8*) data;
+			bytes.insert(bytes.end(), p, p+length);
+		}
+		bool read(void* data, int length) {
+			if(readPos+length > bytes.size()) {return false;}
+			memcpy(data, &bytes[readPos], length);
+			readPos += length;
+			return true;
+		}
+
+		template<class T> void put(const T& value) {write(&value, sizeof(T));}
+		template<class T> bool get(T& value) {return read(&value, sizeof(T));}
+
+		//Vectors of plain entities (trivially copyable, no pointers) are copied as one block
+		template<class T> void putArray(const vector<T>& v) {
+			static_assert(is_trivially_copyable<T>::value, "Only plain entities can be stored as a block");
+			put((Uint32) v.size());
+			write(v.data(), v.size()*sizeof(T));
+		}
+		template<class T> bool getArray(vector<T>& v) {
+			Uint32 count;
+			if(!get(count) || readPos+count*sizeof(T) > bytes.size()) {return false;}
+			v.clear();
+			if(count > 0) {
+				//Fill with copies of the first element, then copy the block over them; no allocation within capacity
+				typename aligned_storage<sizeof(T), alignof(T)>::type first;
+				memcpy(&first, &bytes[readPos], sizeof(T));
+				v.assign(count, *reinterpret_cast<T*>(&first));
+				memcpy(v.data(), &bytes[readPos], count*sizeof(T));
+				readPos += count*sizeof(T);
+			}
+			return true;
+		}
+};
+
+//Fixed-capacity storage for entities that come and go in waves. Room for the largest wave is reserved
+//once and reused by every wave after it, so spawning and clearing never allocate; spawns past capacity are refused.
+template<class T> class Pool{
+		int capacity;
+
+	public:
+		vector<T> items;	//The live entities, in no particular order
+
+		Pool(int size): capacity(size) {items.reserve(size);}
+
+		//Constructs an entity in the next free slot; NULL when the pool is full
+		template<class... Args> T* spawn(Args&&... args) {
+			if(items.size() >= capacity) {return NULL;}
+			items.emplace_back(std::forward<Args>(args)...);
+			return &items.back();
+		}
+
+		//Moves the last entity into slot i, so nothing shifts; loops that erase must look at slot i again
+		void erase(int i) {
+			if(i+1 < (int) items.size()) {items[i] = std::move(items.back());}
+			items.pop_back();
+		}
+		void clear() {items.clear();}
+		int size() {return items.size();}
+		T& operator[](int i) {return items[i];}
+};
+
+//Players by the tile cell their centre is in, so a bullet or a moving player only tests the players
+//around it; the cost of a hit test stays the same however many players there are
+class PlayerGrid{
+		Sint8 head[Map::COLS*Map::ROWS];	//First player listed in each cell, -1 for none
+		Sint8 next[MAX_PLAYERS];	//Next player in the same cell
+		Sint16 cellOf[MAX_PLAYERS];	//Where each player is listed, -1 if nowhere
+
+		void unlist(int player);
+
+	public:
+		PlayerGrid() {clear();}
+
+		void clear();
+
+		//Lists the player at the given point, taking them off wherever they were listed before
+		void place(int player, int x, int y);
+
+		//The lowest numbered player listed in the point's cell or the eight around it that passes the test,
+		//or -1. That reaches a tile past the point, further than a player or bullet can touch
+		template<class Test> int find(int x, int y, Test test) {
+			int col = min(max(x/Tile::WIDTH, 0), Map::COLS-1), row = min(max(y/Tile::HEIGHT, 0), Map::ROWS-1);
+			int found = -1;
+			for(int i = max(col-1, 0); i <= min(col+1, Map::COLS-1); ++i) {
+				for(int j = max(row-1, 0); j <= min(row+1, Map::ROWS-1); ++j) {
+					for(int p = head[i*Map::ROWS+j]; p >= 0; p = next[p]) {
+						if((found < 0 || p < found) && test(p)) {found = p;}
+					}
+				}
+			}
+			return found;
+		}
+};
+
+//One player's place in a match, as read from players.txt
+struct PlayerSlot{
+		int col, row;	//Spawn cell; the nearest walkable one is used on levels where that is blocked
+		int look;	//1 for the first player's textures, 2 for the second's
+		SDL_Scancode keys[6];	//Up, left, down, right, shoot, place bomb
+};
+
+//Horde mode's enemies: thousands of them bouncing around the playfield, hurting whoever they touch.
+//One array per field, as in ParticleSystem, and updated a batch at a time in straight loops the compiler
+//can vectorize. Positions and speeds are whole sub pixels, so every machine computes the same match.
+class Horde{
+	public:
+		static const int SUBPIXEL = 16;	//Sub pixels per pixel
+		static const int WIDTH = Enemy::WIDTH, HEIGHT = Enemy::HEIGHT;
+		static const int MIN_SPEED = 8, MAX_SPEED = 24;	//Sub pixels per tick, on each axis
+		static const int HIT_COOLDOWN = TICK_RATE;	//Ticks a player is safe from the horde after it hurt them
+		static const int BATCH = 256;	//Enemies per pass, so a batch's scratch stays in the L1 cache
+
+		//Top left corners and velocities, in sub pixels
+		vector<Sint32> x, y, vx, vy;
+		vector<Uint8> ready;	//Set while touching nobody; an enemy only hurts on the tick it makes contact
+		int lastHit[MAX_PLAYERS];	//Tick each player was last hurt by the horde
+
+		Horde();
+
+		//Room for the whole horde up front, so spawning never allocates
+		void reserve(int count);
+
+		//Adds enemies at random spawnable cells of the current level, which must have some
+		void spawn(GameWorld&, int count);
+
+		void clear();
+		int size() {return x.size();}
+
+		//Moves every enemy one tick, bouncing off the playfield edges, walls and players, and hurts the players touched
+		void update(GameWorld&);
+
+		void render();
+
+		void save(Snapshot&);
+		bool load(Snapshot&);
+};
+
+//Everything one match owns: levels, entities, timers, clock and random state.
+//Worlds share nothing but the read-only tiles, layouts and textures, so any number can run side by side.
+class GameWorld{
+	public:
+		//Entity limits, so a match never grows its containers; a shot or bomb past them doesn't happen
+		static const int MAX_BULLETS = 128;
+		static const int MAX_BOMBS = 32;
+		static const int MAX_IMPACTS = 256;
+		static const int MAX_ENEMY_BULLETS = 1024;	//Each lives no longer than it takes to cross the field, so a few static enemies never get near this
+
+		vector<Map> levels;
+		vector<Player> players;
+		PlayerGrid playerGrid;	//Kept up to date as players move
+		Pool<Bullet> bullets;
+		Pool<PowerUp> powerUps;	//Both pools are sized for the busiest moment of any level's waves
+		Pool<Enemy> enemies;
+		Pool<Bullet> enemyBullets;
+		Pool<Bomb> bombs;
+
+		//Enemy bullet counts for instrumentation: the most alive at once, the live count summed over ticks
+		//(for the mean), and shots refused because the pool was full
+		int enemyBulletPeak;
+		long long enemyBulletTicks;
+		int enemyBulletsRefused;
+
+		//Horde mode: hordeSize enemies kept on the field instead of the waves' enemies; 0 when off
+		Horde horde;
+		int hordeSize;
+
+		//Bombs that went off and where bullets stopped during the last ticks; whoever draws them clears them
+		Pool<Bomb> explosions;
+		vector<SDL_Point> impacts;	//At most MAX_IMPACTS; more in one frame are not shown
+
+		//Rand device
+		Rng rng;
+
+		//The match clock: ticks simulated so far, advanced once at the start of each tick.
+		//Timers are the tick they started at, so there is one clock to pause, save and replay.
+		int frame;
+
+		//Tick the level clock started at
+		int levelStart;
+
+		//Tick the current level's wave schedule started at, and the next of its events to happen
+		int waveStart;
+		int waveCursor;
+
+		//The current level
+		int level;
+
+		//Level duration in seconds
+		int levelDuration;
+
+		//For resetting the game
+		bool reset;
+
+		//For pausing the game
+		bool disableCon;
+
+		//Game over flag, set when the level time runs out
+		bool gameOver;
+
+		//Print power up pickups and such; off for headless matches
+		bool verbose;
+
+		//Where match events go, if anywhere, and this match's number in that stream
+		TelemetryStream* telemetry;
+		Uint32 match;
+
+		//Copies the loaded level layouts and places the players, at most MAX_PLAYERS and no more than players.txt has slots for
+		GameWorld(Uint32 seed, int playerCount = 2);
+
+		Map& map() {return levels[level];}
+		WaveSchedule& waves();
+
+		//Whole seconds of game time since the given tick
+		int secondsSince(int tick) {return (frame-tick)/TICK_RATE;}
+
+		//Seconds left on the level clock
+		int timeLeft() {return levelDuration - secondsSince(levelStart);}
+
+		//Advances the game by one tick; inputs holds one input byte per player
+		void tick(const Uint8* inputs);
+
+		//Turns on horde mode, with room for that many enemies reserved
+		void startHorde(int size);
+
+		//Reset game
+		void restart();
+
+		//Puts every player on their slot's spawn cell of the current level
+		void placePlayers();
+
+		//The player with the highest value of a stat such as &Player::score, or -1 if more than one has it
+		int leader(int Player::* stat);
+
+		//Collision checkers against the world's bombs and enemies
+		bool checkBombCollide(Circle& player);
+		bool checkEnemyCollide(Circle& player, int*, bool collisionReady);
+
+		//Starts sending match events to the stream
+		void attachTelemetry(TelemetryStream*, Uint32 match);
+
+		//Sends an event (TelemetryEvents) to the attached stream, if any; player -1 for none
+		void record(int type, int player, int x, int y, int value = 0);
+
+		//Top left corner of a random spawnable cell of the current level, avoiding cells something already stands on.
+		//The level must have at least one
+		SDL_Point spawnPoint();
+
+		//Spawns or clears everything of the given wave of the current level
+		void startWave(int wave);
+		void endWave(int wave);
+
+		//Captures/restores the whole match (entities, tiles, timers, power ups, clock, random state)
+		void snapshot(Snapshot&);
+		bool restore(Snapshot&);
+		Uint32 checksum();
+};
+
+//Decides what a player does each tick: held directions as (1<<UP) etc., SHOOT and PLACEBOMB as presses
+class Controller{
+	public:
+		virtual ~Controller() {};
+
+		//Key presses and releases, with the time they happened (event.key.timestamp)
+		virtual void keyEvent(Uint32 timestamp, SDL_Scancode, bool down) {};
+
+		//The real time the next tick ends at; key events up to then belong to it
+		virtual void setTickEnd(Uint32 time) {};
+
+		//The input for the next tick of the given player
+		virtual Uint8 next(GameWorld&, int player) = 0;
+};
+
+//Queues key events and applies each to the tick it happened in, so a tap shorter than a frame still counts
+class KeyboardController: public Controller{
+		struct KeyEvent{
+			Uint32 timestamp;
+			Uint8 bit;
+			bool down;
+		};
+		static const int QUEUE_SIZE = 64;
+
+		SDL_Scancode con[6];
+		KeyEvent queue[QUEUE_SIZE];	//Events not applied to a tick yet, oldest first
+		int queueStart, queueLength;
+		Uint32 tickEnd;
+		Uint8 held;	//Directions held as of the last applied event
+		Uint8 pressed;	//Keys pressed since the last tick
+
+		void apply(const KeyEvent&);
+
+	public:
+		KeyboardController(SDL_Scancode up, SDL_Scancode left, SDL_Scancode down, SDL_Scancode right, SDL_Scancode shoot, SDL_Scancode placebomb):
+			con{up, left, down, right, shoot, placebomb}, queueStart(0), queueLength(0), tickEnd(0), held(0), pressed(0) {};
+
+		void keyEvent(Uint32, SDL_Scancode, bool);
+		void setTickEnd(Uint32);
+		Uint8 next(GameWorld&, int);
+};
+
+//Plays back recorded inputs (see --record/--replay); does nothing once they run out
+class ReplayController: public Controller{
+		vector<Uint8> inputs;
+		int position;
+
+	public:
+		ReplayController(const vector<Uint8>& recorded):
+			inputs(recorded), position(0) {};
+
+		Uint8 next(GameWorld&, int);
+};
+
+//Computer player: goes for power ups, then the opponent, and shoots when lined up.
+//Only looks at a few positions per tick so headless matches run fast.
+class BotController: public Controller{
+		Rng rng;	//Own generator, so bots never change the game's random numbers
+		int lastX, lastY;	//Where the player was last tick, to notice walls
+		int detourTicks;
+		Uint8 detour;
+		Uint8 facing;
+		int shootCooldown;
+
+	public:
+		BotController(Uint32 seed):
+			rng{seed != 0 ? seed : 1}, lastX(-1), lastY(-1), detourTicks(0), detour(0), facing(0), shootCooldown(0) {};
+
+		Uint8 next(GameWorld&, int);
+};
+
+//Collision checkers
+bool checkCollision(Circle& c1, Circle& c2);
+bool checkCollision(Circle& c1, SDL_Rect r);
+bool checkIfEnclosed(SDL_Rect& smallerArea, SDL_Rect& largerArea);
+
+//Creates the shared tile types; needs no renderer
+void createTiles();
+
+//Reads every level in the maps file into gLevelLayouts
+bool loadLevels(string path);
+
+//Reads the waves file into gWaveSchedules, one schedule per level
+bool loadWaves(string path);
+
+//Reads the players file into gPlayerSlots
+bool loadPlayerSlots(string path);
+
+//The window renderer
+extern SDL_Renderer* gRenderer;
+
+//Globally used font
+extern TTF_Font* gFont;
+
+//Textures shared by every world
+extern LTexture gPlayerOneTexture;
+extern LTexture gPlayerTwoTexture;
+extern LTexture gPlayerOneShieldTexture;
+extern LTexture gPlayerTwoShieldTexture;
+extern LTexture gEnemyTexture;
+
+extern LTexture gBombPowerUPTexture;
+extern LTexture gShieldTexture;
+extern LTexture gLifeTexture;
+extern LTexture gBulletUpgradeTexture;
+extern LTexture gSpeedUpTexture;
+extern LTexture gLifeAvailableTexture;
+
+extern LTexture gBombTexture;
+extern LTexture gExplosionTexture;
+
+extern LTexture gSpriteSheet;
+extern Tile* gTiles[TOTAL_TILES];
+
+//Level layouts as read from maps.txt; every world starts from copies of these
+extern vector<Map> gLevelLayouts;
+
+//Wave schedules as read from waves.txt, by level; shared read-only like the layouts
+extern vector<WaveSchedule> gWaveSchedules;
+
+//Spawn cells, looks and keys by player, as read from players.txt
+extern vector<PlayerSlot> gPlayerSlots;
+
+extern LTexture* powerUpsTex[NPOWERUPS];
+
+#endif
@@ -0,0 +1,157 @@
+#include "game.h"
+#include "renderqueue.h"
+#include "telemetry.h"
+
+Horde::Horde() {
+	for(int i = 0; i < MAX_PLAYERS; ++i) {
+		lastHit[i] = -HIT_COOLDOWN;
+	}
+}
+
+void Horde::reserve(int count) {
+	x.reserve(count);
+	y.reserve(count);
+	vx.reserve(count);
+	vy.reserve(count);
+	ready.reserve(count);
+}
+
+void Horde::spawn(GameWorld& world, int count) {
+	Map& map = world.map();
+	for(int i = 0; i < count; ++i) {
+		//Anywhere in a random spawnable cell, heading off diagonally at a random speed
+		SDL_Point cell = map.spawnCell(world.rng()%map.spawnCellCount());
+		x.push_back((cell.x+world.rng()%(Tile::WIDTH-WIDTH+1))*SUBPIXEL);
+		y.push_back((cell.y+world.rng()%(Tile::HEIGHT-HEIGHT+1))*SUBPIXEL);
+		int speedX = MIN_SPEED+world.rng()%(MAX_SPEED-MIN_SPEED+1), speedY = MIN_SPEED+world.rng()%(MAX_SPEED-MIN_SPEED+1);
+		vx.push_back(world.rng()%2 == 0 ? speedX : -speedX);
+		vy.push_back(world.rng()%2 == 0 ? speedY : -speedY);
+		ready.push_back(1);
+	}
+}
+
+void Horde::clear() {
+	x.clear();
+	y.clear();
+	vx.clear();
+	vy.clear();
+	ready.clear();
+}
+
+void Horde::update(GameWorld& world) {
+	//Walls by cell, looked up with one index instead of a Tile call per enemy
+	Uint8 blocked[Map::COLS*Map::ROWS];
+	for(int i = 0; i < Map::COLS; ++i) {
+		for(int j = 0; j < Map::ROWS; ++j) {
+			blocked[i*Map::ROWS+j] = TileSet<Blocking>::has(world.map().tileMap[i][j]->getTileType());
+		}
+	}
+
+	//Player centres in pixels, and who can still be hurt
+	int players = world.players.size();
+	int playerX[MAX_PLAYERS], playerY[MAX_PLAYERS];
+	Uint8 vulnerable = 0;
+	for(int p = 0; p < players; ++p) {
+		playerX[p] = world.players[p].getCollider().x;
+		playerY[p] = world.players[p].getCollider().y;
+		if(!world.players[p].shieldEnable && world.frame-lastHit[p] >= HIT_COOLDOWN) {vulnerable |= 1<<p;}
+	}
+	const int reach = Player::WIDTH/2+WIDTH/2;
+
+	const int maxX = (SCREEN_WIDTH-WIDTH)*SUBPIXEL, maxY = (PLAYFIELD_HEIGHT-HEIGHT)*SUBPIXEL;
+	const int cellW = Tile::WIDTH*SUBPIXEL, cellH = Tile::HEIGHT*SUBPIXEL;
+	Sint32* px = x.data();
+	Sint32* py = y.data();
+	Sint32* pvx = vx.data();
+	Sint32* pvy = vy.data();
+	int count = size();
+
+	for(int start = 0; start < count; start += BATCH) {
+		int n = count-start < BATCH ? count-start : BATCH;
+		Sint32* bx = px+start;
+		Sint32* by = py+start;
+		Sint32* bvx = pvx+start;
+		Sint32* bvy = pvy+start;
+		Uint8 hitX[BATCH], hitY[BATCH], touched[BATCH];
+
+		//Step, turning back instead at the playfield edges. Arithmetic on 0/1 flags rather than branches,
+		//so this loop and the ones below vectorize
+		for(int i = 0; i < n; ++i) {
+			Sint32 nx = bx[i]+bvx[i], ny = by[i]+bvy[i];
+			Sint32 outX = (nx < 0) | (nx > maxX), outY = (ny < 0) | (ny > maxY);
+			bx[i] = nx-outX*bvx[i];
+			by[i] = ny-outY*bvy[i];
+			bvx[i] -= 2*outX*bvx[i];
+			bvy[i] -= 2*outY*bvy[i];
+		}
+
+		//Walls: the cell the leading edge moved into, level with the centre on the other axis. This one is a
+		//gather, so it stays scalar unless the target has gather instructions
+		for(int i = 0; i < n; ++i) {
+			int col = (bx[i]+(bvx[i] > 0 ? WIDTH*SUBPIXEL-1 : 0))/cellW, centreRow = (by[i]+HEIGHT*SUBPIXEL/2)/cellH;
+			int row = (by[i]+(bvy[i] > 0 ? HEIGHT*SUBPIXEL-1 : 0))/cellH, centreCol = (bx[i]+WIDTH*SUBPIXEL/2)/cellW;
+			hitX[i] = blocked[col*Map::ROWS+centreRow];
+			hitY[i] = blocked[centreCol*Map::ROWS+row];
+		}
+		for(int i = 0; i < n; ++i) {
+			bx[i] -= hitX[i]*bvx[i];
+			by[i] -= hitY[i]*bvy[i];
+			bvx[i] -= 2*hitX[i]*bvx[i];
+			bvy[i] -= 2*hitY[i]*bvy[i];
+		}
+
+		//Who touches whom, one bit per player
+		for(int i = 0; i < n; ++i) {
+			touched[i] = 0;
+		}
+		for(int p = 0; p < players; ++p) {
+			int cx = playerX[p]-WIDTH/2, cy = playerY[p]-HEIGHT/2;
+			for(int i = 0; i < n; ++i) {
+				int dx = bx[i]/SUBPIXEL-cx, dy = by[i]/SUBPIXEL-cy;
+				touched[i] |= (dx*dx+dy*dy < reach*reach) << p;
+			}
+		}
+
+		//Contacts are few; only they take the slow path
+		Uint8* bready = ready.data()+start;
+		for(int i = 0; i < n; ++i) {
+			if(touched[i] == 0) {
+				bready[i] = 1;
+				continue;
+			}
+			if(bready[i]) {
+				for(int p = 0; p < players; ++p) {
+					if(touched[i] & vulnerable & (1<<p)) {
+						world.players[p].life--;
+						world.record(EVENT_HIT, p, bx[i]/SUBPIXEL, by[i]/SUBPIXEL, HIT_ENEMY);
+						lastHit[p] = world.frame;
+						vulnerable &= ~(1<<p);
+					}
+				}
+				bvx[i] = -bvx[i];
+				bvy[i] = -bvy[i];
+			}
+			bready[i] = 0;
+		}
+	}
+}
+
+void Horde::render() {
+	for(int i = 0; i < size(); ++i) {
+		gRenderQueue.push(LAYER_ENEMIES, &gEnemyTexture, {x[i]/SUBPIXEL, y[i]/SUBPIXEL, WIDTH, HEIGHT});
+	}
+}
+
+void Horde::save(Snapshot& s) {
+	s.putArray(x);
+	s.putArray(y);
+	s.putArray(vx);
+	s.putArray(vy);
+	s.putArray(ready);
+	s.put(lastHit);
+}
+
+bool Horde::load(Snapshot& s) {
+	return s.getArray(x) && s.getArray(y) && s.getArray(vx) && s.getArray(vy) && s.getArray(ready) && s.get(lastHit)
+		&& y.size() == x.size() && vx.size() == x.size() && vy.size() == x.size() && ready.size() == x.size();
+}
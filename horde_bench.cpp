@@ -0,0 +1,88 @@
+//Horde mode benchmark: simulates bot matches on one core with ever bigger hordes and reports the biggest whose
+//ticks still fit in a 60 FPS frame. Usage: horde_bench [--ticks N] [--seed N] [--players N]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bundle.h"
+#include "game.h"
+#include "logger.h"
+
+//Mean and worst tick time in milliseconds of a match with the given horde, over that many ticks
+static void measure(int hordeSize, int players, int ticks, Uint32 seed, double& mean, double& worst) {
+	GameWorld world(seed, players);
+	world.verbose = false;
+	world.startHorde(hordeSize);
+	vector<BotController> bots;
+	for(int i = 0; i < world.players.size(); ++i) {
+		bots.push_back(BotController(seed^(0x9E3779B9*(i+1))));
+	}
+	Uint8 inputs[MAX_PLAYERS];
+
+	//Only ticks that start with the whole horde out count; levels walled in by bricks hold none for a while
+	double total = 0;
+	int timed = 0;
+	worst = 0;
+	for(int t = 0; timed < ticks && t < 100*ticks; ++t) {
+		for(int i = 0; i < world.players.size(); ++i) {
+			inputs[i] = bots[i].next(world, i);
+		}
+		bool full = world.horde.size() == hordeSize;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		world.tick(inputs);
+		double ms = chrono::duration<double, milli>(chrono::steady_clock::now()-start).count();
+		if(full) {
+			total += ms;
+			worst = max(worst, ms);
+			++timed;
+		}
+		world.explosions.clear();
+		world.impacts.clear();
+	}
+	mean = total/max(timed, 1);
+}
+
+int main(int argc, char *args[]) {
+	int ticks = 20*TICK_RATE;
+	int players = 2;
+	Uint32 seed = 1;
+	for(int i = 1; i < argc; ++i) {
+		string arg = args[i];
+		if(arg == "--ticks" && i+1 < argc) {
+			ticks = max(atoi(args[++i]), 1);
+		} else if(arg == "--seed" && i+1 < argc) {
+			seed = strtoul(args[++i], NULL, 10);
+		} else if(arg == "--players" && i+1 < argc) {
+			players = min(max(atoi(args[++i]), 2), MAX_PLAYERS);
+		} else {
+			printf("Unknown option %s\n", args[i]);
+			printf("Usage: horde_bench [--ticks N] [--seed N] [--players N]\n");
+			return 1;
+		}
+	}
+
+	gLogger.consoleLevel = LOG_LEVEL_INFO;
+	createTiles();
+	unpackBundle();
+	if(!loadLevels("maps.txt") || !loadWaves("waves.txt") || !loadPlayerSlots("players.txt")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load the level files!");
+		return 1;
+	}
+
+	//A whole frame at 60 FPS; the game also has to draw in it, so this is an upper bound
+	const double budget = 1000.0/60;
+	int sustained = 0;
+	printf("%d ticks per run, %d players\n", ticks, players);
+	for(int hordeSize = 1000; hordeSize <= 1024000; hordeSize *= 2) {
+		double mean, worst;
+		measure(hordeSize, players, ticks, seed, mean, worst);
+		printf("%7d enemies: %.3f ms per tick, worst %.3f ms\n", hordeSize, mean, worst);
+		if(mean > budget) {break;}
+		sustained = hordeSize;
+	}
+	printf("Largest horde simulated at 60 FPS: %d enemies\n", sustained);
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include "levelgen.h"
+
+//Steel and water stay put for good; everything else can be walked or bombed through
+static bool passable(Uint8 type) {
+	return !TileSet<Permanent>::has(type);
+}
+
+//Marks every cell reachable from (col, row), returning how many spawns it reached. The queue is a fixed
+//array, so a fill never allocates.
+static int flood(const LevelTiles tiles, int col, int row, const SDL_Point* spawns, int spawnCount, Uint8 reached[Map::COLS][Map::ROWS]) {
+	static const int steps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+	Sint16 queue[Map::COLS*Map::ROWS];
+	int head = 0, tail = 0;
+	if(!reached[col][row]) {
+		reached[col][row] = 1;
+		queue[tail++] = col*Map::ROWS+row;
+	}
+	while(head < tail) {
+		int c = queue[head]/Map::ROWS, r = queue[head]%Map::ROWS;
+		++head;
+		for(int i = 0; i < 4; ++i) {
+			int nc = c+steps[i][0], nr = r+steps[i][1];
+			if(nc < 0 || nc >= Map::COLS || nr < 0 || nr >= Map::ROWS || reached[nc][nr] || !passable(tiles[nc][nr])) {continue;}
+			reached[nc][nr] = 1;
+			queue[tail++] = nc*Map::ROWS+nr;
+		}
+	}
+
+	int count = 0;
+	for(int i = 0; i < spawnCount; ++i) {
+		count += reached[spawns[i].x][spawns[i].y];
+	}
+	return count;
+}
+
+int generateLevel(Uint32 seed, const LevelDensity& density, const SDL_Point* spawns, int spawnCount, LevelTiles tiles) {
+	Rng rng{seed != 0 ? seed : 1};
+
+	//Cumulative thresholds on a 32 bit draw, so a cell costs one random number and a few compares
+	const double scale = 4294967296.0;
+	double cuts[4] = {density.brick, density.steel, density.water, density.slide};
+	Uint32 limits[4];
+	double sum = 0;
+	for(int i = 0; i < 4; ++i) {
+		sum += max(cuts[i], 0.0);
+		limits[i] = (Uint32) min(sum*scale, scale-1);
+	}
+
+	for(int c = 0; c < Map::COLS; ++c) {
+		for(int r = 0; r < Map::ROWS; ++r) {
+			Uint32 roll = rng();
+			if(roll < limits[0]) {
+				tiles[c][r] = BRICK;
+			} else if(roll < limits[1]) {
+				tiles[c][r] = STEEL;
+			} else if(roll < limits[2]) {
+				tiles[c][r] = WATER;
+			} else if(roll < limits[3]) {
+				tiles[c][r] = SLIDE_DOWN+(roll&3);
+			} else {
+				tiles[c][r] = GRASS;
+			}
+		}
+	}
+	for(int i = 0; i < spawnCount; ++i) {
+		tiles[spawns[i].x][spawns[i].y] = GRASS;
+	}
+	if(spawnCount < 2) {return 0;}
+
+	//Dig from each cut off spawn towards the first, along a random axis first, until it meets reached ground
+	Uint8 reached[Map::COLS][Map::ROWS] = {};
+	int dug = 0;
+	int connected = flood(tiles, spawns[0].x, spawns[0].y, spawns, spawnCount, reached);
+	for(int i = 1; i < spawnCount && connected < spawnCount; ++i) {
+		int c = spawns[i].x, r = spawns[i].y;
+		if(reached[c][r]) {continue;}
+		bool columnsFirst = rng()%2 == 0;
+		while(!reached[c][r]) {
+			if(!passable(tiles[c][r])) {tiles[c][r] = GRASS;}
+			bool alongRow = columnsFirst ? c != spawns[0].x : r == spawns[0].y;
+			if(alongRow) {
+				c += c < spawns[0].x ? 1 : -1;
+			} else {
+				r += r < spawns[0].y ? 1 : -1;
+			}
+		}
+		++dug;
+		connected = flood(tiles, spawns[i].x, spawns[i].y, spawns, spawnCount, reached);
+	}
+	return dug;
+}
+
+bool spawnsConnected(const LevelTiles tiles, const SDL_Point* spawns, int spawnCount) {
+	if(spawnCount == 0) {return true;}
+	Uint8 reached[Map::COLS][Map::ROWS] = {};
+	return flood(tiles, spawns[0].x, spawns[0].y, spawns, spawnCount, reached) == spawnCount;
+}
+
+void writeLevel(string& out, const string& name, const LevelTiles tiles) {
+	out += "[";
+	out += name;
+	out += "]\n";
+	for(int r = 0; r < Map::ROWS; ++r) {
+		for(int c = 0; c < Map::COLS; ++c) {
+			if(c > 0) {out += '\t';}
+			out += (char) ('0'+tiles[c][r]);
+		}
+		out += '\n';
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef LEVELGEN_H
+#define LEVELGEN_H
+
+#include <SDL2/SDL.h>
+#include <string>
+
+#include "game.h"
+
+//Share of the cells each tile type gets, 0 to 1; whatever is left is grass. Slides face a random way.
+struct LevelDensity{
+		double brick, steel, water, slide;
+};
+
+//Tile type numbers by column and row, like Map::tileMap
+typedef Uint8 LevelTiles[Map::COLS][Map::ROWS];
+
+//Fills tiles with a random level. The spawn cells are grass, and every one of them can reach the first
+//through cells a player can walk or bomb through, i.e. anything but steel and water; where the dice
+//cut one off, a corridor is dug straight to the others. The same seed, density and spawns always give
+//the same level. Returns how many corridors were dug.
+int generateLevel(Uint32 seed, const LevelDensity&, const SDL_Point* spawns, int spawnCount, LevelTiles tiles);
+
+//Whether every spawn cell can reach the first, as generateLevel promises
+bool spawnsConnected(const LevelTiles tiles, const SDL_Point* spawns, int spawnCount);
+
+//Appends a level as a [name] section of a maps file: a line per row of tab separated type numbers
+void writeLevel(string& out, const string& name, const LevelTiles tiles);
+
+#endif
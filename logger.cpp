@@ -0,0 +1,128 @@
+#include "logger.h"
+
+#include <chrono>
+#include <cstdarg>
+
+Logger gLogger;
+
+static const char* levelNames[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+static const char* categoryNames[TOTAL_LOG_CATEGORIES] = {"system", "assets", "render", "game", "net", "io"};
+
+//Prefixes the time, level and category; returns the length written
+static int formatLine(const LogEntry& entry, char* line, int size) {
+	int length = snprintf(line, size, "[%6u.%03u] %-5s %s: %s\n", entry.time/1000, entry.time%1000,
+		levelNames[entry.level], categoryNames[entry.category], entry.text);
+	return length < size ? length : size-1;
+}
+
+Logger::Logger():
+	running(false), stopping(false), file(NULL), fileBytes(0), consoleLevel(LOG_LEVEL_WARN), dropped(0) {}
+
+Logger::~Logger() {
+	close();
+}
+
+bool Logger::open(string logPath) {
+	close();
+
+	path = logPath;
+	rotate();
+	if(file == NULL) {
+		fprintf(stderr, "Unable to open log file %s!\n", path.c_str());
+		return false;
+	}
+
+	stopping = false;
+	dropped = 0;
+	writer = thread(&Logger::writeEntries, this);
+	running.store(true, memory_order_release);
+	return true;
+}
+
+void Logger::write(int level, int category, const char* format, ...) {
+	LogEntry entry;
+	entry.time = SDL_GetTicks();
+	entry.level = level;
+	entry.category = category;
+	va_list args;
+	va_start(args, format);
+	vsnprintf(entry.text, sizeof(entry.text), format, args);
+	va_end(args);
+
+	if(running.load(memory_order_acquire)) {
+		if(!queue.push(entry)) {
+			++dropped;
+		}
+	} else if(level >= consoleLevel) {
+		char line[300];
+		formatLine(entry, line, sizeof(line));
+		fputs(line, stderr);
+	}
+}
+
+void Logger::writeEntries() {
+	while(true) {
+		//Read the flag first, so nothing logged before close() is left behind
+		bool last = stopping.load(memory_order_acquire);
+		bool any = false;
+		LogEntry entry;
+		while(queue.pop(entry)) {
+			writeEntry(entry);
+			any = true;
+		}
+		if(any) {
+			//Keep the file current, so it's useful after a crash
+			if(file != NULL) {fflush(file);}
+			fflush(stderr);
+		} else if(last) {
+			break;
+		} else {
+			this_thread::sleep_for(chrono::milliseconds(5));
+		}
+	}
+}
+
+void Logger::writeEntry(const LogEntry& entry) {
+	char line[300];
+	int length = formatLine(entry, line, sizeof(line));
+	if(entry.level >= consoleLevel) {
+		fputs(line, stderr);
+	}
+	if(file == NULL) {return;}
+
+	fileBytes += fwrite(line, 1, length, file);
+	if(fileBytes >= MAX_BYTES) {
+		rotate();
+	}
+}
+
+//Shifts path.1 ... path.KEEP-1 up one, moves the current log to path.1 and starts a new one
+void Logger::rotate() {
+	if(file != NULL) {
+		fclose(file);
+		file = NULL;
+	}
+	for(int i = KEEP; i > 0; --i) {
+		string from = i == 1 ? path : path+"."+to_string(i-1);
+		string to = path+"."+to_string(i);
+		remove(to.c_str());	//rename won't replace a file on Windows
+		rename(from.c_str(), to.c_str());
+	}
+	file = fopen(path.c_str(), "w");
+	fileBytes = 0;
+}
+
+void Logger::close() {
+	if(!running) {return;}
+
+	running.store(false, memory_order_release);
+	stopping.store(true, memory_order_release);
+	writer.join();
+	if(dropped > 0) {
+		fprintf(file != NULL ? file : stderr, "%d log messages dropped\n", dropped.load());
+	}
+	if(file != NULL) {
+		fclose(file);
+		file = NULL;
+	}
+}
@@ -0,0 +1,88 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "ringqueue.h"
+
+using namespace std;
+
+enum LogLevels{
+	LOG_LEVEL_DEBUG, LOG_LEVEL_INFO, LOG_LEVEL_WARN, LOG_LEVEL_ERROR
+};
+
+enum LogCategories{
+	LOG_SYSTEM, LOG_ASSETS, LOG_RENDER, LOG_GAME, LOG_NET, LOG_IO, TOTAL_LOG_CATEGORIES
+};
+
+//Messages below this level are compiled out, arguments and all; build with -DLOG_MIN_LEVEL=0 for debug messages
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+
+//printf style: DEBUG_LOG(LOG_GAME, "Wave %d started", wave). No trailing newline.
+#define LOG_AT(level, category, ...) do {if((level) >= LOG_MIN_LEVEL) {gLogger.write(level, category, __VA_ARGS__);}} while(0)
+#define DEBUG_LOG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#define INFO_LOG(category, ...) LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define WARN_LOG(category, ...) LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#define ERROR_LOG(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+
+#ifdef __GNUC__
+#define LOG_FORMAT __attribute__((format(printf, 4, 5)))
+#else
+#define LOG_FORMAT
+#endif
+
+//One formatted message waiting to be written
+struct LogEntry{
+		Uint32 time;	//SDL_GetTicks
+		Uint8 level;
+		Uint8 category;
+		char text[250];	//Longer messages are cut short
+};
+
+//Leveled, categorised log. The caller formats the message and pushes it onto a lock-free queue; a writer thread
+//puts it in the log file, rotating the file once it grows past MAX_BYTES, and echoes warnings and errors to stderr.
+//Until open() (and after close()) messages at the console level go straight to stderr instead.
+class Logger{
+		static const int CAPACITY = 1024;	//Entries; a power of two
+		static const long MAX_BYTES = 1 << 20;
+		static const int KEEP = 3;	//Rotated files kept as path.1 (newest) to path.KEEP
+
+		RingQueue<LogEntry, CAPACITY> queue;
+		atomic<bool> running;
+		atomic<bool> stopping;
+		thread writer;
+		FILE* file;
+		string path;
+		long fileBytes;
+
+		void writeEntries();
+		void writeEntry(const LogEntry&);
+		void rotate();
+
+	public:
+		int consoleLevel;	//Messages at or above this are also shown on stderr
+		atomic<int> dropped;	//Messages lost because the queue was full
+
+		Logger();
+		~Logger();
+
+		//Starts a new log at path, moving an existing one to path.1
+		bool open(string path);
+		bool isOpen() {return running;}
+
+		//Safe from any thread; never waits on the disk. Use the macros above rather than calling this.
+		void write(int level, int category, const char* format, ...) LOG_FORMAT;
+
+		//Writes out what is queued and stops the writer
+		void close();
+};
+
+extern Logger gLogger;
+
+#endif
@@ -0,0 +1,101 @@
+#include "lz.h"
+
+#include <cstring>
+
+static const int MIN_MATCH = 4;
+static const int MAX_OFFSET = 0xFFFF;
+static const int HASH_BITS = 14;
+
+static Uint32 hash4(const Uint8* p) {
+	Uint32 v = p[0] | p[1] << 8 | p[2] << 16 | (Uint32) p[3] << 24;
+	return v*2654435761u >> (32-HASH_BITS);
+}
+
+static void putLength(vector<Uint8>& out, int n) {
+	while(n >= 255) {
+		out.push_back(255);
+		n -= 255;
+	}
+	out.push_back(n);
+}
+
+//Literals, then a match unless length is 0 (the last sequence)
+static void putSequence(vector<Uint8>& out, const Uint8* literals, int count, int offset, int length) {
+	int extra = length > 0 ? length-MIN_MATCH : 0;
+	out.push_back((count < 15 ? count : 15) << 4 | (extra < 15 ? extra : 15));
+	if(count >= 15) {putLength(out, count-15);}
+	out.insert(out.end(), literals, literals+count);
+	if(length == 0) {return;}
+	out.push_back(offset & 0xFF);
+	out.push_back(offset >> 8);
+	if(extra >= 15) {putLength(out, extra-15);}
+}
+
+vector<Uint8> lzCompress(const Uint8* in, int size) {
+	vector<Uint8> out;
+	vector<int> lastSeen(1 << HASH_BITS, -1);	//Latest position of each hashed four bytes
+	int anchor = 0;	//Start of the literals not written yet
+	int pos = 0;
+	while(pos+MIN_MATCH <= size) {
+		Uint32 h = hash4(in+pos);
+		int candidate = lastSeen[h];
+		lastSeen[h] = pos;
+		if(candidate < 0 || pos-candidate > MAX_OFFSET || memcmp(in+candidate, in+pos, MIN_MATCH) != 0) {
+			++pos;
+			continue;
+		}
+
+		int length = MIN_MATCH;
+		while(pos+length < size && in[candidate+length] == in[pos+length]) {
+			++length;
+		}
+		putSequence(out, in+anchor, pos-anchor, pos-candidate, length);
+		pos += length;
+		anchor = pos;
+	}
+	putSequence(out, in+anchor, size-anchor, 0, 0);
+	return out;
+}
+
+static bool getLength(const Uint8*& in, const Uint8* end, int& n) {
+	Uint8 b;
+	do {
+		if(in >= end) {return false;}
+		b = *in++;
+		n += b;
+	} while(b == 255);
+	return true;
+}
+
+bool lzDecompress(const Uint8* in, int packedSize, Uint8* out, int size) {
+	const Uint8* end = in+packedSize;
+	Uint8* op = out;
+	Uint8* outEnd = out+size;
+	while(in < end) {
+		int token = *in++;
+
+		int count = token >> 4;
+		if(count == 15 && !getLength(in, end, count)) {return false;}
+		if(count > end-in || count > outEnd-op) {return false;}
+		memcpy(op, in, count);
+		in += count;
+		op += count;
+		if(in == end) {break;}
+
+		if(end-in < 2) {return false;}
+		int offset = in[0] | in[1] << 8;
+		in += 2;
+		int length = token & 15;
+		if(length == 15 && !getLength(in, end, length)) {return false;}
+		length += MIN_MATCH;
+		if(offset == 0 || offset > op-out || length > outEnd-op) {return false;}
+
+		//Byte by byte: a match may overlap what it is copying
+		const Uint8* match = op-offset;
+		for(int i = 0; i < length; ++i) {
+			op[i] = match[i];
+		}
+		op += length;
+	}
+	return op == outEnd;
+}
@@ -0,0 +1,19 @@
+#ifndef LZ_H
+#define LZ_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+using namespace std;
+
+//A small LZ77 byte format for the asset bundle. The stream is a run of sequences: a token byte (literal count
+//in the high four bits, match length-4 in the low four; 15 means more length bytes follow, each adding up to
+//255), the literals, then a two byte little endian offset back into the output. The last sequence is literals only.
+
+//Packs size bytes from in
+vector<Uint8> lzCompress(const Uint8* in, int size);
+
+//Unpacks into out, which must be exactly the unpacked size; false if the data is damaged
+bool lzDecompress(const Uint8* in, int packedSize, Uint8* out, int size);
+
+#endif
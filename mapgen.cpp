@@ -0,0 +1,89 @@
+//Generates a corpus of random levels in the maps.txt format, for stress testing on many layouts.
+//Usage: mapgen [--count N] [--seed N] [--brick F] [--steel F] [--water F] [--slide F] [--players N] [--out FILE]
+//Level i comes from seed+i, so any one of them can be made again on its own.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bundle.h"
+#include "game.h"
+#include "levelgen.h"
+#include "logger.h"
+
+int main(int argc, char *args[]) {
+	int count = 1000;
+	Uint32 seed = 1;
+	int players = MAX_PLAYERS;
+	LevelDensity density = {0.4, 0.1, 0.05, 0.05};	//Close to the hand made levels
+	const char* outPath = NULL;
+	for(int i = 1; i < argc; ++i) {
+		string arg = args[i];
+		if(arg == "--count" && i+1 < argc) {
+			count = max(atoi(args[++i]), 1);
+		} else if(arg == "--seed" && i+1 < argc) {
+			seed = strtoul(args[++i], NULL, 10);
+		} else if(arg == "--brick" && i+1 < argc) {
+			density.brick = atof(args[++i]);
+		} else if(arg == "--steel" && i+1 < argc) {
+			density.steel = atof(args[++i]);
+		} else if(arg == "--water" && i+1 < argc) {
+			density.water = atof(args[++i]);
+		} else if(arg == "--slide" && i+1 < argc) {
+			density.slide = atof(args[++i]);
+		} else if(arg == "--players" && i+1 < argc) {
+			players = min(max(atoi(args[++i]), 2), MAX_PLAYERS);
+		} else if(arg == "--out" && i+1 < argc) {
+			outPath = args[++i];
+		} else {
+			printf("Unknown option %s\n", args[i]);
+			printf("Usage: mapgen [--count N] [--seed N] [--brick F] [--steel F] [--water F] [--slide F] [--players N] [--out FILE]\n");
+			return 1;
+		}
+	}
+	if(density.brick+density.steel+density.water+density.slide > 1) {
+		printf("Tile densities add up to more than 1!\n");
+		return 1;
+	}
+
+	//Spawns are the players' starting cells from players.txt
+	gLogger.consoleLevel = LOG_LEVEL_WARN;
+	unpackBundle();
+	if(!loadPlayerSlots("players.txt")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load players.txt!");
+		return 1;
+	}
+	vector<SDL_Point> spawns;
+	for(int i = 0; i < min(players, (int) gPlayerSlots.size()); ++i) {
+		spawns.push_back({min(max(gPlayerSlots[i].col, 0), Map::COLS-1), min(max(gPlayerSlots[i].row, 0), Map::ROWS-1)});
+	}
+
+	string out;
+	out.reserve((size_t) count*(Map::COLS*2+1)*Map::ROWS+count*16);
+	LevelTiles tiles;
+	int dug = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(int i = 0; i < count; ++i) {
+		dug += generateLevel(seed+i, density, spawns.data(), spawns.size(), tiles);
+		if(!spawnsConnected(tiles, spawns.data(), spawns.size())) {
+			printf("Level %d came out with its spawns cut off!\n", i+1);
+			return 1;
+		}
+		writeLevel(out, "Level "+to_string(i+1), tiles);
+	}
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now()-start).count();
+
+	FILE* file = outPath != NULL ? fopen(outPath, "w") : stdout;
+	if(file == NULL) {
+		printf("Unable to open %s!\n", outPath);
+		return 1;
+	}
+	fwrite(out.data(), 1, out.size(), file);
+	if(file != stdout) {fclose(file);}
+
+	fprintf(stderr, "%d levels for %d players in %.1f ms (%.0f per second), %d corridors dug to join spawns\n",
+		count, (int) spawns.size(), ms, count/max(ms/1000, 1e-9), dug);
+	return 0;
+}
@@ -0,0 +1,308 @@
+#include "net.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+UdpLink::UdpLink():
+	sock(-1), peerIp(0), peerPort(0), lossRng(random_device()()), latency(0), jitter(0), loss(0) {}
+
+UdpLink::~UdpLink() {
+	close();
+}
+
+bool UdpLink::open(int localPort, const char* host, int remotePort) {
+	#ifdef _WIN32
+	WSADATA wsaData;
+	if(WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		ERROR_LOG(LOG_NET, "Unable to start Winsock!");
+		return false;
+	}
+	#endif
+
+	//Look up the peer
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	addrinfo* found = NULL;
+	if(getaddrinfo(host, NULL, &hints, &found) != 0 || found == NULL) {
+		ERROR_LOG(LOG_NET, "Unable to resolve peer %s!", host);
+		return false;
+	}
+	peerIp = ((sockaddr_in*) found->ai_addr)->sin_addr.s_addr;
+	peerPort = htons((Uint16) remotePort);
+	freeaddrinfo(found);
+
+	//Create a non-blocking socket on the local port
+	sock = (int) socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if(sock < 0) {
+		ERROR_LOG(LOG_NET, "Unable to create UDP socket!");
+		return false;
+	}
+	sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port = htons((Uint16) localPort);
+	if(bind(sock, (sockaddr*) &local, sizeof(local)) < 0) {
+		ERROR_LOG(LOG_NET, "Unable to bind UDP port %d!", localPort);
+		close();
+		return false;
+	}
+	#ifdef _WIN32
+	u_long nonBlocking = 1;
+	ioctlsocket(sock, FIONBIO, &nonBlocking);
+	#else
+	fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+	#endif
+	return true;
+}
+
+void UdpLink::close() {
+	if(sock >= 0) {
+		#ifdef _WIN32
+		closesocket(sock);
+		WSACleanup();
+		#else
+		::close(sock);
+		#endif
+		sock = -1;
+	}
+	outbox.clear();
+}
+
+void UdpLink::transmit(const Uint8* data, int length) {
+	sockaddr_in peer;
+	memset(&peer, 0, sizeof(peer));
+	peer.sin_family = AF_INET;
+	peer.sin_addr.s_addr = peerIp;
+	peer.sin_port = peerPort;
+	sendto(sock, (const char*) data, length, 0, (sockaddr*) &peer, sizeof(peer));
+}
+
+void UdpLink::send(const Uint8* data, int length) {
+	if(sock < 0) {return;}
+
+	//Simulated packet loss
+	if(loss > 0 && (int) (lossRng()%100) < loss) {return;}
+
+	if(latency <= 0 && jitter <= 0) {
+		transmit(data, length);
+	} else {
+		Uint32 delay = latency;
+		if(jitter > 0) {delay += lossRng()%(jitter+1);}
+		outbox.push_back({SDL_GetTicks()+delay, vector<Uint8>(data, data+length)});
+	}
+}
+
+void UdpLink::flush() {
+	Uint32 now = SDL_GetTicks();
+	for(int i = 0; i < outbox.size(); ) {
+		if((Sint32) (now-outbox[i].sendTime) >= 0) {
+			transmit(outbox[i].data.data(), outbox[i].data.size());
+			outbox.erase(outbox.begin()+i);
+		} else {
+			++i;
+		}
+	}
+}
+
+int UdpLink::receive(Uint8* buffer, int capacity) {
+	if(sock < 0) {return 0;}
+
+	sockaddr_in from;
+	socklen_t fromLength = sizeof(from);
+	int length = recvfrom(sock, (char*) buffer, capacity, 0, (sockaddr*) &from, &fromLength);
+	if(length <= 0 || from.sin_addr.s_addr != peerIp || from.sin_port != peerPort) {
+		return 0;
+	}
+	return length;
+}
+
+//Packet layout: magic, first input tick, ack, sender tick, advantage, sync tick, sync checksum, input count, inputs
+static const Uint32 NET_MAGIC = 0x504E4D42;	//"BMNP"
+static const int NET_HEADER = 29;
+
+static void writeU32(Uint8* p, Uint32 value) {
+	p[0] = value; p[1] = value >> 8; p[2] = value >> 16; p[3] = value >> 24;
+}
+
+static Uint32 readU32(const Uint8* p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((Uint32) p[3] << 24);
+}
+
+NetSession::NetSession():
+	world(NULL), localPlayer(0), currentTick(0), remoteConfirmed(-1), remoteAck(-1), remoteTick(0), remoteAdvantage(0), rollbackFrom(-1), stallCooldown(0), lastReceived(0), syncTick(-1),
+	rollbacks(0), resimulatedTicks(0), stalls(0), desynced(false), connected(false) {
+	memset(localInputs, 0, sizeof(localInputs));
+	memset(remoteInputs, 0, sizeof(remoteInputs));
+	memset(usedRemoteInputs, 0, sizeof(usedRemoteInputs));
+	memset(checksums, 0, sizeof(checksums));
+	for(int i = 0; i < HISTORY; ++i) {checksumTicks[i] = -1;}
+}
+
+bool NetSession::open(GameWorld& game, int player, int localPort, const char* host, int remotePort, int latency, int jitter, int loss) {
+	world = &game;
+	localPlayer = player;
+	link.latency = latency;
+	link.jitter = jitter;
+	link.loss = loss;
+	return link.open(localPort, host, remotePort);
+}
+
+void NetSession::close() {
+	link.close();
+}
+
+Uint8 NetSession::remoteInput(int t) {
+	if(t <= remoteConfirmed) {
+		return remoteInputs[t%INPUT_HISTORY];
+	}
+	//Prediction: the peer keeps holding the same directions and presses nothing new
+	if(remoteConfirmed < 0) {
+		return 0;
+	}
+	return remoteInputs[remoteConfirmed%INPUT_HISTORY] & ~((1<<SHOOT) | (1<<PLACEBOMB));
+}
+
+void NetSession::simulate(int t) {
+	world->snapshot(states[t%HISTORY]);
+
+	//Every input before this tick is known, so this state is final on both ends
+	if(t <= remoteConfirmed+1) {
+		checksums[t%HISTORY] = world->checksum();
+		checksumTicks[t%HISTORY] = t;
+		if(t > syncTick) {syncTick = t;}
+	}
+
+	Uint8 inputs[2];
+	inputs[localPlayer] = localInputs[t%INPUT_HISTORY];
+	inputs[1-localPlayer] = usedRemoteInputs[t%HISTORY] = remoteInput(t);
+	world->tick(inputs);
+}
+
+void NetSession::receive() {
+	Uint8 packet[NET_HEADER+MAX_SENT_INPUTS];
+	int length;
+
+	link.flush();
+	while((length = link.receive(packet, sizeof(packet))) > 0) {
+		if(length < NET_HEADER || readU32(packet) != NET_MAGIC || length < NET_HEADER+packet[NET_HEADER-1]) {
+			continue;
+		}
+		int first = (Sint32) readU32(packet+4);
+		int ack = (Sint32) readU32(packet+8);
+		int senderTick = (Sint32) readU32(packet+12);
+		int advantage = (Sint32) readU32(packet+16);
+		int peerSyncTick = (Sint32) readU32(packet+20);
+		Uint32 peerChecksum = readU32(packet+24);
+		int count = packet[NET_HEADER-1];
+
+		connected = true;
+		lastReceived = SDL_GetTicks();
+		if(ack > remoteAck) {remoteAck = ack;}
+		if(senderTick >= remoteTick) {
+			remoteTick = senderTick;
+			remoteAdvantage = advantage;
+		}
+
+		for(int i = 0; i < count; ++i) {
+			int t = first+i;
+			if(t <= remoteConfirmed) {continue;}
+			if(t > remoteConfirmed+1) {break;}
+
+			Uint8 input = packet[NET_HEADER+i];
+			remoteInputs[t%INPUT_HISTORY] = input;
+			remoteConfirmed = t;
+
+			//That tick already ran on a guess; rewind if the guess was wrong
+			if(t < currentTick && usedRemoteInputs[t%HISTORY] != input && (rollbackFrom < 0 || t < rollbackFrom)) {
+				rollbackFrom = t;
+			}
+		}
+
+		if(!desynced && peerSyncTick >= 0 && checksumTicks[peerSyncTick%HISTORY] == peerSyncTick && checksums[peerSyncTick%HISTORY] != peerChecksum) {
+			ERROR_LOG(LOG_NET, "Desync detected at tick %d!", peerSyncTick);
+			desynced = true;
+		}
+	}
+
+	if(rollbackFrom >= 0) {
+		world->restore(states[rollbackFrom%HISTORY]);
+		int lastTick = currentTick;
+		for(int t = rollbackFrom; t < lastTick; ++t) {
+			simulate(t);
+			if(world->gameOver) {
+				currentTick = t+1;
+				break;
+			}
+		}
+		++rollbacks;
+		resimulatedTicks += lastTick-rollbackFrom;
+		rollbackFrom = -1;
+	}
+}
+
+void NetSession::advance(Uint8 localInput) {
+	if(!connected) {return;}
+
+	//Too far ahead of what the peer has confirmed to be able to rewind: wait for it
+	if(currentTick-remoteConfirmed > MAX_ROLLBACK || currentTick-remoteAck >= INPUT_HISTORY) {
+		++stalls;
+		return;
+	}
+
+	//Running ahead of the peer in time: skip a tick now and then so it can catch up
+	int localAdvantage = currentTick-remoteTick;
+	if(stallCooldown > 0) {
+		--stallCooldown;
+	} else if((localAdvantage-remoteAdvantage)/2 >= 1) {
+		stallCooldown = TICK_RATE/6;
+		++stalls;
+		return;
+	}
+
+	localInputs[currentTick%INPUT_HISTORY] = localInput;
+	simulate(currentTick);
+	++currentTick;
+}
+
+void NetSession::send() {
+	Uint8 packet[NET_HEADER+MAX_SENT_INPUTS];
+
+	//Everything the peer hasn't acknowledged yet, so lost packets don't matter
+	int first = max(remoteAck+1, 0);
+	int count = min(currentTick-first, (int) MAX_SENT_INPUTS);
+	if(count < 0) {count = 0;}
+
+	writeU32(packet, NET_MAGIC);
+	writeU32(packet+4, first);
+	writeU32(packet+8, remoteConfirmed);
+	writeU32(packet+12, currentTick);
+	writeU32(packet+16, currentTick-remoteTick);
+	writeU32(packet+20, syncTick);
+	writeU32(packet+24, syncTick >= 0 ? checksums[syncTick%HISTORY] : 0);
+	packet[NET_HEADER-1] = count;
+	for(int i = 0; i < count; ++i) {
+		packet[NET_HEADER+i] = localInputs[(first+i)%INPUT_HISTORY];
+	}
+
+	link.send(packet, NET_HEADER+count);
+	link.flush();
+}
@@ -0,0 +1,105 @@
+#ifndef NET_H
+#define NET_H
+
+#include <SDL2/SDL.h>
+#include <random>
+#include <vector>
+
+#include "game.h"
+
+//UDP socket talking to a single peer.
+//Outgoing packets can be delayed and dropped on purpose to test netplay on loopback.
+class UdpLink{
+		struct Delayed{
+			Uint32 sendTime;
+			std::vector<Uint8> data;
+		};
+
+		int sock;
+		Uint32 peerIp;	//Network byte order
+		Uint16 peerPort;	//Network byte order
+		std::vector<Delayed> outbox;
+		std::mt19937 lossRng;
+
+		void transmit(const Uint8*, int);
+
+	public:
+		//Simulated network conditions
+		int latency;	//Milliseconds added to every packet
+		int jitter;	//Random extra milliseconds, up to this much
+		int loss;	//Percent of packets dropped
+
+		UdpLink();
+		~UdpLink();
+
+		//Binds the local port and sets the peer address; returns false on failure
+		bool open(int localPort, const char* host, int remotePort);
+		void close();
+
+		//Queues a packet for the peer (sent right away unless latency is simulated)
+		void send(const Uint8* data, int length);
+
+		//Sends queued packets whose simulated delay has passed
+		void flush();
+
+		//Reads one pending packet from the peer; returns its length, or 0 if there is none
+		int receive(Uint8* buffer, int capacity);
+};
+
+//Two-player match over UDP with rollback: the remote player's input is predicted, and when
+//the real input arrives and differs, the game is rewound to that tick and re-simulated
+class NetSession{
+		static const int MAX_ROLLBACK = 15;	//Ticks we may run ahead of the last confirmed remote input
+		static const int HISTORY = MAX_ROLLBACK+2;	//Saved states
+		static const int INPUT_HISTORY = 256;	//Saved inputs (must cover everything the peer has not acknowledged)
+		static const int MAX_SENT_INPUTS = 64;
+
+		UdpLink link;
+		GameWorld* world;
+		int localPlayer;
+		int currentTick;	//Next tick to simulate
+		int remoteConfirmed;	//Last tick whose remote input has arrived
+		int remoteAck;	//Last tick of our input the peer has confirmed
+		int remoteTick;	//The peer's currentTick, as last reported
+		int remoteAdvantage;	//How far the peer thinks it is ahead of us
+		int rollbackFrom;	//Earliest mispredicted tick, or -1
+		int stallCooldown;
+		Uint32 lastReceived;
+
+		Uint8 localInputs[INPUT_HISTORY];
+		Uint8 remoteInputs[INPUT_HISTORY];
+		Uint8 usedRemoteInputs[HISTORY];	//The remote input each saved tick was simulated with
+		Snapshot states[HISTORY];	//The state at the start of each saved tick
+		Uint32 checksums[HISTORY];	//Checksums of fully confirmed states, to detect desyncs
+		int checksumTicks[HISTORY];
+		int syncTick;
+
+		Uint8 remoteInput(int tick);
+		void simulate(int tick);
+
+	public:
+		//Statistics
+		int rollbacks;
+		int resimulatedTicks;
+		int stalls;
+		bool desynced;
+
+		bool connected;
+
+		NetSession();
+
+		//Plays the given world against the peer
+		bool open(GameWorld& world, int player, int localPort, const char* host, int remotePort, int latency, int jitter, int loss);
+		void close();
+
+		//Reads packets from the peer and rolls back if a prediction turned out wrong
+		void receive();
+
+		//Simulates the next tick with the local input, unless we are too far ahead of the peer
+		void advance(Uint8 localInput);
+
+		//Sends the local inputs the peer has not acknowledged yet
+		void send();
+};
+
+#endif
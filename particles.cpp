@@ -0,0 +1,94 @@
+#include "particles.h"
+
+#include <cmath>
+
+static const float DRAG = 0.92f;	//Speed kept per 1/60 s
+static const float GRAVITY = 60.0f;	//Pixels per second squared; smoke and sparks sink a little
+static const int SIZE = 3;
+
+//Fresh to burnt out: white-yellow, orange, red, grey smoke
+static const SDL_Color shadeColors[ParticleSystem::SHADES] = {{255, 240, 160, 255}, {255, 150, 40, 230}, {200, 50, 20, 200}, {90, 90, 90, 150}};
+
+ParticleSystem::ParticleSystem():
+	count(0), rng{0x1F123BB5}, dropped(0) {}
+
+float ParticleSystem::random() {
+	return (rng() >> 8)*(1.0f/16777216.0f);
+}
+
+void ParticleSystem::emit(float px, float py, int n, float speed, float lifeTime) {
+	if(count+n > CAPACITY) {
+		dropped += count+n-CAPACITY;
+		n = CAPACITY-count;
+	}
+	for(int i = count; i < count+n; ++i) {
+		float angle = random()*2*PI;
+		float v = speed*(0.2f+0.8f*random());
+		x[i] = px;
+		y[i] = py;
+		vx[i] = v*cosf(angle);
+		vy[i] = v*sinf(angle);
+		lifeSpan[i] = life[i] = lifeTime*(0.5f+0.5f*random());
+	}
+	count += n;
+}
+
+void ParticleSystem::explosion(int px, int py) {
+	emit(px, py, 300, 260.0f, 0.9f);
+}
+
+void ParticleSystem::impact(int px, int py) {
+	emit(px, py, 12, 120.0f, 0.25f);
+}
+
+void ParticleSystem::update(float seconds) {
+	float drag = powf(DRAG, seconds*TICK_RATE);
+	float fall = GRAVITY*seconds;
+
+	//No branches or calls, so the compiler can vectorize this
+	for(int i = 0; i < count; ++i) {
+		x[i] += vx[i]*seconds;
+		y[i] += vy[i]*seconds;
+		vx[i] *= drag;
+		vy[i] = vy[i]*drag+fall;
+		life[i] -= seconds;
+	}
+
+	//Retire burnt out particles by moving the last one into their place
+	for(int i = 0; i < count;) {
+		if(life[i] > 0) {
+			++i;
+			continue;
+		}
+		--count;
+		x[i] = x[count];
+		y[i] = y[count];
+		vx[i] = vx[count];
+		vy[i] = vy[count];
+		life[i] = life[count];
+		lifeSpan[i] = lifeSpan[count];
+	}
+}
+
+void ParticleSystem::render() {
+	int shadeCount[SHADES] = {0};
+	for(int i = 0; i < count; ++i) {
+		int shade = (int) ((1.0f-life[i]/lifeSpan[i])*SHADES);
+		if(shade >= SHADES) {shade = SHADES-1;}
+		SDL_Rect& r = rects[shade][shadeCount[shade]++];
+		r.x = (int) x[i]-SIZE/2;
+		r.y = (int) y[i]-SIZE/2;
+		r.w = SIZE;
+		r.h = SIZE;
+	}
+
+	SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_BLEND);
+	//Burnt out first, so fresh sparks end up on top
+	for(int s = SHADES-1; s >= 0; --s) {
+		if(shadeCount[s] > 0) {
+			SDL_SetRenderDrawColor(gRenderer, shadeColors[s].r, shadeColors[s].g, shadeColors[s].b, shadeColors[s].a);
+			SDL_RenderFillRects(gRenderer, rects[s], shadeCount[s]);
+		}
+	}
+	SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_NONE);
+}
@@ -0,0 +1,53 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL2/SDL.h>
+
+#include "game.h"
+
+//Explosion and bullet impact particles. Purely visual: the game never reads them, so they live
+//outside GameWorld, use their own random numbers and advance with real frame time.
+//Fixed capacity, one array per field, so updating is a straight loop and nothing is allocated after startup.
+class ParticleSystem{
+	public:
+		static const int CAPACITY = 8192;
+		static const int SHADES = 4;	//Colour steps from fresh to burnt out; one draw call each
+
+	private:
+		float x[CAPACITY];
+		float y[CAPACITY];
+		float vx[CAPACITY];
+		float vy[CAPACITY];
+		float life[CAPACITY];	//Seconds left
+		float lifeSpan[CAPACITY];	//Seconds it started with
+		int count;
+
+		SDL_Rect rects[SHADES][CAPACITY];	//Scratch space for batching by shade
+		Rng rng;
+
+		void emit(float px, float py, int n, float speed, float lifeTime);
+		float random();	//0 to 1
+
+	public:
+		//Particles that didn't fit because the pool was full
+		int dropped;
+
+		ParticleSystem();
+
+		//Fire burst where a bomb went off (x, y is the bomb's tile centre)
+		void explosion(int x, int y);
+
+		//A few sparks where a bullet stopped
+		void impact(int x, int y);
+
+		//Moves every particle and retires burnt out ones
+		void update(float seconds);
+
+		//Draws all particles, one SDL_RenderFillRects call per shade
+		void render();
+
+		int size() {return count;}
+		void clear() {count = 0;}
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "renderqueue.h"
+
+#include <cstdio>
+
+#include "framearena.h"
+
+RenderQueue gRenderQueue;
+
+RenderQueue::RenderQueue():
+	lastPushed(NULL), frames(0), drawCalls(0), textureSwitches(0), unsortedSwitches(0), commandCount(0) {
+	commands.reserve(INITIAL_COMMANDS);
+}
+
+void RenderQueue::reserve(int count) {
+	commands.reserve(count);
+	gFrameArena.reserve(count*(sizeof(RenderCommand)+sizeof(SDL_Rect))+64*1024);
+}
+
+void RenderQueue::push(int layer, LTexture* texture, SDL_Rect dst, const SDL_Rect* src, double angle) {
+	RenderCommand c;
+	c.key = layer << 8 | (texture->getId() & 0xFF);
+	c.texture = texture;
+	c.dst = dst;
+	c.clip = src != NULL;
+	if(src != NULL) {c.src = *src;}
+	c.angle = (Sint16) angle;
+	commands.push_back(c);
+
+	if(texture != lastPushed) {
+		++unsortedSwitches;
+		lastPushed = texture;
+	}
+}
+
+void RenderQueue::pushRect(int layer, SDL_Color color, SDL_Rect dst) {
+	RenderCommand c;
+	c.key = layer << 8;
+	c.texture = NULL;
+	c.dst = dst;
+	c.clip = false;
+	c.angle = 0;
+	c.color = color;
+	commands.push_back(c);
+}
+
+void RenderQueue::sort() {
+	//Least significant byte first; counting sort per byte keeps equal keys in push order.
+	//Two passes, so the result ends up back in commands.
+	RenderCommand* from = commands.data();
+	RenderCommand* to = gFrameArena.allocArray<RenderCommand>(commands.size());
+	for(int shift = 0; shift < 16; shift += 8) {
+		int offsets[257] = {0};
+		for(int i = 0; i < commands.size(); ++i) {
+			++offsets[(from[i].key >> shift & 0xFF)+1];
+		}
+		for(int b = 0; b < 256; ++b) {
+			offsets[b+1] += offsets[b];
+		}
+		for(int i = 0; i < commands.size(); ++i) {
+			to[offsets[from[i].key >> shift & 0xFF]++] = from[i];
+		}
+		swap(from, to);
+	}
+}
+
+void RenderQueue::submit() {
+	sort();
+
+	SDL_Rect* rects = gFrameArena.allocArray<SDL_Rect>(commands.size());
+	LTexture* bound = NULL;
+	for(int i = 0; i < commands.size();) {
+		RenderCommand& c = commands[i];
+		if(c.texture == NULL) {
+			//A run of same coloured rectangles is one call
+			int j = i;
+			while(j < commands.size() && commands[j].texture == NULL && commands[j].key == c.key
+				&& commands[j].color.r == c.color.r && commands[j].color.g == c.color.g && commands[j].color.b == c.color.b && commands[j].color.a == c.color.a) {
+				rects[j-i] = commands[j].dst;
+				++j;
+			}
+			SDL_SetRenderDrawColor(gRenderer, c.color.r, c.color.g, c.color.b, c.color.a);
+			SDL_RenderFillRects(gRenderer, rects, j-i);
+			++drawCalls;
+			i = j;
+			continue;
+		}
+
+		if(c.texture != bound) {
+			++textureSwitches;
+			bound = c.texture;
+		}
+		c.texture->render(&c.dst, c.clip ? &c.src : NULL, c.angle);
+		++drawCalls;
+		++i;
+	}
+
+	++frames;
+	commandCount += commands.size();
+	commands.clear();
+	lastPushed = NULL;
+}
+
+void RenderQueue::report() {
+	if(frames == 0) {
+		printf("No frames rendered\n");
+		return;
+	}
+	printf("Render queue over %d frames: %.1f commands, %.1f draw calls, %.1f texture switches per frame (%.1f in submission order)\n",
+		frames, (double) commandCount/frames, (double) drawCalls/frames, (double) textureSwitches/frames, (double) unsortedSwitches/frames);
+}
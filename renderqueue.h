@@ -0,0 +1,64 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+#include "game.h"
+
+//Draw order, bottom first
+enum Layers{
+	LAYER_TILES, LAYER_ITEMS, LAYER_ENEMIES, LAYER_BULLETS, LAYER_PLAYERS, LAYER_EFFECTS, TOTAL_LAYERS
+};
+
+//One sprite or filled rectangle to draw. key is the layer, then the texture id, so sorting by key
+//groups each layer's draws by texture; rectangles have no texture and sort first in their layer.
+struct RenderCommand{
+		Uint16 key;
+		LTexture* texture;	//NULL for a filled rectangle
+		SDL_Rect dst;
+		SDL_Rect src;
+		bool clip;	//Whether src is used
+		Sint16 angle;
+		SDL_Color color;	//For rectangles
+};
+
+//Collects a frame's playfield draws, then sorts and submits them in one go, so each texture is bound once
+//per layer and runs of rectangles go out as one SDL_RenderFillRects. The sort is a stable radix sort, so
+//draws with the same layer and texture keep the order they were pushed in. Sorting and batching scratch comes
+//from gFrameArena.
+class RenderQueue{
+		static const int INITIAL_COMMANDS = 4096;
+
+		vector<RenderCommand> commands;	//Keeps its capacity between frames
+		LTexture* lastPushed;
+
+		void sort();
+
+	public:
+		//Totals over every submit, for --render-stats
+		int frames;
+		long long drawCalls;
+		long long textureSwitches;
+		long long unsortedSwitches;	//Texture switches the frames would have needed in push order
+		long long commandCount;
+
+		RenderQueue();
+
+		void push(int layer, LTexture* texture, SDL_Rect dst, const SDL_Rect* src = NULL, double angle = 0.0);
+		void pushRect(int layer, SDL_Color color, SDL_Rect dst);
+
+		//Sorts and draws everything pushed since the last submit, then empties the queue
+		void submit();
+
+		//Room for frames of that many draws, queue and scratch, so a crowded match doesn't grow them mid-play
+		void reserve(int count);
+
+		//Prints draw calls and texture switches per frame
+		void report();
+};
+
+//Playfield draws of the frame being rendered
+extern RenderQueue gRenderQueue;
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+#include <SDL2/SDL.h>
+#include <atomic>
+
+using namespace std;
+
+//Fixed size lock-free queue: any number of threads push, one thread pops. Every slot carries a sequence number
+//that says whether it is free to be written at position p (p) or holds the item pushed at position p (p+1).
+//Pushing never waits; when the queue is full it fails instead.
+template<class T, int CAPACITY> class RingQueue{
+		static_assert((CAPACITY & (CAPACITY-1)) == 0, "RingQueue capacity must be a power of two");
+
+		struct Slot{
+				atomic<Uint32> sequence;
+				T item;
+		};
+
+		Slot slots[CAPACITY];
+		atomic<Uint32> writePos;	//Next position to push at, shared by producers
+		Uint32 readPos;	//Next position to pop; consumer only
+
+	public:
+		RingQueue(): writePos(0), readPos(0) {
+			for(int i = 0; i < CAPACITY; ++i) {
+				slots[i].sequence.store(i, memory_order_relaxed);
+			}
+		}
+
+		//Safe from any thread; false if the queue is full
+		bool push(const T& item) {
+			//Claim a position whose slot the consumer has emptied
+			Uint32 pos = writePos.load(memory_order_relaxed);
+			Slot* slot;
+			while(true) {
+				slot = &slots[pos & (CAPACITY-1)];
+				Sint32 diff = (Sint32) (slot->sequence.load(memory_order_acquire)-pos);
+				if(diff == 0) {
+					if(writePos.compare_exchange_weak(pos, pos+1, memory_order_relaxed)) {break;}
+				} else if(diff < 0) {
+					//Full: the consumer is a whole ring behind
+					return false;
+				} else {
+					pos = writePos.load(memory_order_relaxed);
+				}
+			}
+			slot->item = item;
+			slot->sequence.store(pos+1, memory_order_release);
+			return true;
+		}
+
+		//Consumer thread only; false if nothing is ready
+		bool pop(T& item) {
+			Slot* slot = &slots[readPos & (CAPACITY-1)];
+			if(slot->sequence.load(memory_order_acquire) != readPos+1) {
+				return false;
+			}
+			item = slot->item;
+			slot->sequence.store(readPos+CAPACITY, memory_order_release);
+			++readPos;
+			return true;
+		}
+};
+
+#endif
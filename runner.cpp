@@ -0,0 +1,240 @@
+//Headless batch runner: plays bot-vs-bot matches on every core and reports throughput and balance numbers.
+//Each thread owns its worlds and its statistics; nothing mutable is shared until the threads are joined.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "allocwatch.h"
+#include "bundle.h"
+#include "game.h"
+#include "logger.h"
+#include "telemetry.h"
+
+struct MatchStats{
+		int matches;
+		int unfinished;	//Hit the tick limit without a winner
+		long long ticks;
+		int wins[MAX_PLAYERS];
+		long long pickups[MAX_PLAYERS][NPOWERUPS];
+		int enemyBulletPeak;	//Most alive at once in any match
+		long long enemyBulletTicks;	//Live enemy bullets summed over every tick
+		long long enemyBulletsRefused;
+		Uint32 digest;	//Sum of the final state checksums; independent of how matches are split across threads
+		long long steadyTicks;	//Ticks after warm-up, and those of them that allocated, with --alloccheck
+		long long allocTicks;
+		long long steadyAllocations;
+};
+
+//With --alloccheck, ticks after the first second of a match must not allocate
+static const int ALLOC_WARMUP = TICK_RATE;
+
+static const char* powerUpNames[NPOWERUPS] = {"life", "bomb", "shield", "bullet upgrade", "speed up"};
+
+//Match events of every thread, when started with --telemetry
+static TelemetryStream telemetry;
+
+//Seed of the given match; spread out so neighbouring matches don't start alike
+static Uint32 matchSeed(Uint32 seed, int match) {
+	Uint32 s = seed+0x9E3779B9*(Uint32) (match+1);
+	s ^= s >> 16;
+	s *= 0x7FEB352D;
+	s ^= s >> 15;
+	return s != 0 ? s : 1;
+}
+
+//Seeds bots with the match seed xor these, one per player
+static const Uint32 botSalts[MAX_PLAYERS] = {0x68E31DA4, 0xB5297A4D, 0x1B56C4E9, 0x7F4A7C15, 0xD2B74407, 0x3C6EF372, 0xA54FF53A, 0x510E527F};
+
+//Plays matches [first, first+count) and adds them up in stats
+static void playMatches(Uint32 seed, int first, int count, int players, int hordeSize, int maxTicks, bool allocCheck, MatchStats* stats) {
+	for(int m = first; m < first+count; ++m) {
+		Uint32 s = matchSeed(seed, m);
+		GameWorld world(s, players);
+		world.verbose = false;
+		if(hordeSize > 0) {
+			world.startHorde(hordeSize);
+		}
+		if(telemetry.isOpen()) {
+			world.attachTelemetry(&telemetry, m);
+		}
+
+		vector<BotController> bots;
+		for(int i = 0; i < players; ++i) {
+			bots.push_back(BotController(s^botSalts[i]));
+		}
+		Uint8 inputs[MAX_PLAYERS];
+		while(!world.gameOver && world.frame < maxTicks) {
+			for(int i = 0; i < players; ++i) {
+				inputs[i] = bots[i].next(world, i);
+			}
+			//Only the tick itself is counted, on this thread; bots and other threads may allocate
+			bool steady = allocCheck && world.frame >= ALLOC_WARMUP;
+			Uint64 allocationsBefore = allocationCount();
+			world.tick(inputs);
+			if(steady) {
+				++stats->steadyTicks;
+				Uint64 allocations = allocationCount()-allocationsBefore;
+				if(allocations > 0) {
+					if(stats->allocTicks == 0) {ERROR_LOG(LOG_SYSTEM, "Match %d tick %d allocated %d times", m, world.frame-1, (int) allocations);}
+					++stats->allocTicks;
+					stats->steadyAllocations += allocations;
+				}
+			}
+			//Nobody draws them here
+			world.explosions.clear();
+			world.impacts.clear();
+		}
+
+		++stats->matches;
+		stats->ticks += world.frame;
+		if(!world.gameOver) {
+			++stats->unfinished;
+		} else {
+			++stats->wins[world.leader(&Player::score)];
+		}
+		for(int i = 0; i < players; ++i) {
+			for(int j = 0; j < NPOWERUPS; ++j) {
+				stats->pickups[i][j] += world.players[i].pickups[j];
+			}
+		}
+		stats->enemyBulletPeak = max(stats->enemyBulletPeak, world.enemyBulletPeak);
+		stats->enemyBulletTicks += world.enemyBulletTicks;
+		stats->enemyBulletsRefused += world.enemyBulletsRefused;
+		stats->digest += world.checksum();
+	}
+}
+
+int main(int argc, char *args[]) {
+	int matches = 100;
+	int threads = thread::hardware_concurrency();
+	Uint32 seed = 1;
+	int players = 2;
+	int hordeSize = 0;
+	int maxTicks = 10*60*TICK_RATE;	//Ten minutes of play
+	const char* telemetryPath = NULL;
+	bool allocCheck = false;
+	string mapsPath = "maps.txt";
+
+	//No log file: loading problems and stream summaries go straight to the console
+	gLogger.consoleLevel = LOG_LEVEL_INFO;
+
+	for(int i = 1; i < argc; ++i) {
+		string arg = args[i];
+		if(arg == "--matches" && i+1 < argc) {
+			matches = atoi(args[++i]);
+		} else if(arg == "--threads" && i+1 < argc) {
+			threads = atoi(args[++i]);
+		} else if(arg == "--seed" && i+1 < argc) {
+			seed = strtoul(args[++i], NULL, 10);
+		} else if(arg == "--players" && i+1 < argc) {
+			players = min(max(atoi(args[++i]), 2), MAX_PLAYERS);
+		} else if(arg == "--horde" && i+1 < argc) {
+			hordeSize = max(atoi(args[++i]), 0);
+		} else if(arg == "--ticks" && i+1 < argc) {
+			maxTicks = atoi(args[++i]);
+		} else if(arg == "--telemetry" && i+1 < argc) {
+			telemetryPath = args[++i];
+		} else if(arg == "--maps" && i+1 < argc) {
+			mapsPath = args[++i];
+		} else if(arg == "--alloccheck") {
+			allocCheck = true;
+		} else {
+			printf("Unknown option %s\n", args[i]);
+			printf("Usage: runner [--matches N] [--threads N] [--seed N] [--players N] [--horde N] [--ticks N] [--telemetry FILE] [--maps FILE] [--alloccheck]\n");
+			return 1;
+		}
+	}
+	#ifndef ALLOC_CHECK
+	if(allocCheck) {
+		printf("--alloccheck needs the allocation check build: make runner_alloccheck\n");
+		return 1;
+	}
+	#endif
+	if(threads < 1) {threads = 1;}
+	if(threads > matches) {threads = max(matches, 1);}
+
+	//Tiles, layouts and waves are shared read-only by every world
+	createTiles();
+	unpackBundle();
+	if(!loadLevels(mapsPath)) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load %s!", mapsPath.c_str());
+		return 1;
+	}
+	if(!loadWaves("waves.txt")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load waves.txt!");
+		return 1;
+	}
+	if(!loadPlayerSlots("players.txt")) {
+		ERROR_LOG(LOG_ASSETS, "Failed to load players.txt!");
+		return 1;
+	}
+	players = min(players, (int) gPlayerSlots.size());
+
+	if(telemetryPath != NULL && !telemetry.open(telemetryPath)) {
+		return 1;
+	}
+
+	vector<MatchStats> stats(threads);
+	vector<thread> workers;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(int t = 0; t < threads; ++t) {
+		MatchStats& s = stats[t];
+		memset(&s, 0, sizeof(s));
+		int first = (long long) matches*t/threads;
+		int last = (long long) matches*(t+1)/threads;
+		workers.emplace_back(playMatches, seed, first, last-first, players, hordeSize, maxTicks, allocCheck, &s);
+	}
+	for(int t = 0; t < threads; ++t) {
+		workers[t].join();
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+	telemetry.close();
+
+	MatchStats total;
+	memset(&total, 0, sizeof(total));
+	for(int t = 0; t < threads; ++t) {
+		total.matches += stats[t].matches;
+		total.unfinished += stats[t].unfinished;
+		total.ticks += stats[t].ticks;
+		for(int i = 0; i < players; ++i) {
+			total.wins[i] += stats[t].wins[i];
+			for(int j = 0; j < NPOWERUPS; ++j) {
+				total.pickups[i][j] += stats[t].pickups[i][j];
+			}
+		}
+		total.enemyBulletPeak = max(total.enemyBulletPeak, stats[t].enemyBulletPeak);
+		total.enemyBulletTicks += stats[t].enemyBulletTicks;
+		total.enemyBulletsRefused += stats[t].enemyBulletsRefused;
+		total.digest += stats[t].digest;
+		total.steadyTicks += stats[t].steadyTicks;
+		total.allocTicks += stats[t].allocTicks;
+		total.steadyAllocations += stats[t].steadyAllocations;
+	}
+
+	printf("%d matches on %d threads in %.2f s: %.1f matches/s, %.0f ticks/s\n", total.matches, threads, seconds, total.matches/seconds, total.ticks/seconds);
+	printf("Wins:");
+	for(int i = 0; i < players; ++i) {
+		printf(" player %d %d,", i+1, total.wins[i]);
+	}
+	printf(" unfinished after %d ticks %d\n", maxTicks, total.unfinished);
+	printf("Average match length: %.0f ticks\n", (double) total.ticks/max(total.matches, 1));
+	for(int j = 0; j < NPOWERUPS; ++j) {
+		printf("Power up %s picked up per match:", powerUpNames[j]);
+		for(int i = 0; i < players; ++i) {
+			printf("%s player %d %.2f", i > 0 ? "," : "", i+1, (double) total.pickups[i][j]/max(total.matches, 1));
+		}
+		printf("\n");
+	}
+	printf("Enemy bullets: peak %d live, mean %.1f, %lld shots refused\n", total.enemyBulletPeak,
+		(double) total.enemyBulletTicks/max(total.ticks, 1LL), total.enemyBulletsRefused);
+	printf("Result digest: %08X\n", total.digest);
+	if(allocCheck) {
+		printf("Allocation check: %lld of %lld ticks after warm-up allocated (%lld allocations)\n", total.allocTicks, total.steadyTicks, total.steadyAllocations);
+		return total.allocTicks > 0 ? 1 : 0;
+	}
+	return 0;
+}
@@ -0,0 +1,67 @@
+#include "telemetry.h"
+#include "logger.h"
+
+#include <chrono>
+#include <cstring>
+
+TelemetryStream::TelemetryStream():
+	stopping(false), file(NULL), dropped(0), written(0) {}
+
+TelemetryStream::~TelemetryStream() {
+	close();
+}
+
+bool TelemetryStream::open(string path) {
+	close();
+
+	file = fopen(path.c_str(), "wb");
+	if(file == NULL) {
+		ERROR_LOG(LOG_IO, "Unable to open %s for telemetry!", path.c_str());
+		return false;
+	}
+	TelemetryHeader header = {{'B', 'M', 'T', 'L'}, TELEMETRY_VERSION, sizeof(TelemetryRecord)};
+	fwrite(&header, sizeof(header), 1, file);
+
+	stopping = false;
+	dropped = 0;
+	written = 0;
+	writer = thread(&TelemetryStream::writeRecords, this);
+	return true;
+}
+
+void TelemetryStream::record(const TelemetryRecord& r) {
+	if(file == NULL) {return;}
+
+	if(!queue.push(r)) {
+		++dropped;
+	}
+}
+
+void TelemetryStream::writeRecords() {
+	TelemetryRecord batch[BATCH];
+	while(true) {
+		//Read the flag first, so nothing recorded before close() is left behind
+		bool last = stopping.load(memory_order_acquire);
+		int count = 0;
+		while(count < BATCH && queue.pop(batch[count])) {
+			++count;
+		}
+		if(count > 0) {
+			written += fwrite(batch, sizeof(TelemetryRecord), count, file);
+		}
+		if(count < BATCH) {
+			if(last) {break;}
+			this_thread::sleep_for(chrono::milliseconds(2));
+		}
+	}
+}
+
+void TelemetryStream::close() {
+	if(file == NULL) {return;}
+
+	stopping.store(true, memory_order_release);
+	writer.join();
+	fclose(file);
+	file = NULL;
+	LOG_AT(dropped > 0 ? LOG_LEVEL_WARN : LOG_LEVEL_INFO, LOG_IO, "Telemetry: %d events written, %d dropped", written, dropped.load());
+}
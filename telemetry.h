@@ -0,0 +1,73 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "ringqueue.h"
+
+using namespace std;
+
+enum TelemetryEvents{
+	EVENT_MATCH_START, EVENT_SHOT, EVENT_HIT, EVENT_PICKUP, EVENT_BOMB_PLACED, EVENT_DETONATION, EVENT_DEATH, EVENT_SET_WON, EVENT_MATCH_END, TOTAL_EVENTS
+};
+
+//What an EVENT_HIT was hit by (its value)
+enum HitCauses{
+	HIT_BULLET, HIT_ENEMY_BULLET, HIT_ENEMY, HIT_BOMB, TOTAL_HIT_CAUSES
+};
+
+//One event, as stored in the file
+struct TelemetryRecord{
+		Uint32 tick;
+		Uint32 match;
+		Uint8 type;	//TelemetryEvents
+		Sint8 player;	//-1 if none (a tied set, a detonation)
+		Sint16 x, y;	//Where it happened; x is the number of players for EVENT_MATCH_START
+		Sint16 value;	//Power up id for pickups, HitCauses for hits
+};
+
+//Start of a telemetry file; the records follow back to back
+struct TelemetryHeader{
+		char magic[4];	//"BMTL"
+		Uint16 version;
+		Uint16 recordSize;
+};
+
+const Uint16 TELEMETRY_VERSION = 1;
+
+//Match events written to a file (--telemetry) without the game ever waiting on the disk.
+//Any number of threads record into a lock-free ring; a writer thread drains it in batches.
+//When the ring is full, events are dropped and counted.
+class TelemetryStream{
+		static const int CAPACITY = 1 << 16;	//Records; a power of two
+		static const int BATCH = 4096;	//Records per write
+
+		RingQueue<TelemetryRecord, CAPACITY> queue;
+		atomic<bool> stopping;
+		thread writer;
+		FILE* file;
+
+		void writeRecords();
+
+	public:
+		atomic<int> dropped;
+		int written;
+
+		TelemetryStream();
+		~TelemetryStream();
+
+		bool open(string path);
+		bool isOpen() {return file != NULL;}
+
+		//Safe from any thread; never blocks
+		void record(const TelemetryRecord&);
+
+		//Writes out what is left, stops the writer and prints the counts
+		void close();
+};
+
+#endif
@@ -0,0 +1,198 @@
+//Reads a telemetry file written with --telemetry (by the game or the runner) and prints per-match and overall statistics
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "game.h"
+#include "telemetry.h"
+
+struct MatchTally{
+		Uint32 ticks;
+		int players;	//From the match start; files that don't say count up to the highest player seen
+		int playersSeen;
+		bool finished;
+		int winner;
+		int shots[MAX_PLAYERS];
+		int hits[MAX_PLAYERS][TOTAL_HIT_CAUSES];	//Taken, by cause
+		int pickups[MAX_PLAYERS][NPOWERUPS];
+		int bombs[MAX_PLAYERS];
+		int detonations;
+		int deaths[MAX_PLAYERS];
+		int sets[MAX_PLAYERS];
+		int tiedSets;
+};
+
+static const char* causeNames[TOTAL_HIT_CAUSES] = {"bullet", "enemy bullet", "enemy", "bomb"};
+static const char* powerUpNames[NPOWERUPS] = {"life", "bomb", "shield", "bullet upgrade", "speed up"};
+
+//A number per player joined by dashes, each padded to width, e.g. " 3-1 " for two players
+static string perPlayer(const int* values, int players, int width) {
+	string s;
+	char buffer[32];
+	for(int p = 0; p < players; ++p) {
+		snprintf(buffer, sizeof(buffer), p == 0 ? "%*d" : "-%-*d", width, values[p]);
+		s += buffer;
+	}
+	return s;
+}
+
+int main(int argc, char *args[]) {
+	bool perMatch = false;
+	const char* path = NULL;
+	for(int i = 1; i < argc; ++i) {
+		string arg = args[i];
+		if(arg == "--matches") {
+			perMatch = true;
+		} else if(path == NULL) {
+			path = args[i];
+		} else {
+			path = NULL;
+			break;
+		}
+	}
+	if(path == NULL) {
+		printf("Usage: telemetry_report [--matches] FILE\n");
+		return 1;
+	}
+
+	FILE* file = fopen(path, "rb");
+	if(file == NULL) {
+		printf("Unable to open %s!\n", path);
+		return 1;
+	}
+	TelemetryHeader header;
+	if(fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "BMTL", 4) != 0) {
+		printf("%s is not a telemetry file!\n", path);
+		fclose(file);
+		return 1;
+	}
+	if(header.version != TELEMETRY_VERSION || header.recordSize != sizeof(TelemetryRecord)) {
+		printf("%s is telemetry version %d with %d byte records; this reader wants version %d with %d\n",
+			path, header.version, header.recordSize, TELEMETRY_VERSION, (int) sizeof(TelemetryRecord));
+		fclose(file);
+		return 1;
+	}
+
+	//Records of different matches are interleaved when the runner used several threads
+	map<Uint32, MatchTally> matches;
+	long long events = 0;
+	TelemetryRecord r;
+	while(fread(&r, sizeof(r), 1, file) == 1) {
+		++events;
+		MatchTally& m = matches[r.match];	//Zeroed when first seen
+		m.ticks = max(m.ticks, r.tick);
+		int p = r.player;
+		bool player = p >= 0 && p < MAX_PLAYERS;
+		if(player) {m.playersSeen = max(m.playersSeen, p+1);}
+		switch(r.type) {
+			case EVENT_MATCH_START:
+				if(r.x > 0) {m.players = min((int) r.x, MAX_PLAYERS);}
+				break;
+			case EVENT_SHOT:
+				if(player) {++m.shots[p];}
+				break;
+			case EVENT_HIT:
+				if(player && r.value >= 0 && r.value < TOTAL_HIT_CAUSES) {++m.hits[p][r.value];}
+				break;
+			case EVENT_PICKUP:
+				if(player && r.value >= 0 && r.value < NPOWERUPS) {++m.pickups[p][r.value];}
+				break;
+			case EVENT_BOMB_PLACED:
+				if(player) {++m.bombs[p];}
+				break;
+			case EVENT_DETONATION:
+				++m.detonations;
+				break;
+			case EVENT_DEATH:
+				if(player) {++m.deaths[p];}
+				break;
+			case EVENT_SET_WON:
+				if(player) {++m.sets[p];}
+				else {++m.tiedSets;}
+				break;
+			case EVENT_MATCH_END:
+				m.finished = true;
+				m.winner = p;
+				break;
+		}
+	}
+	fclose(file);
+
+	if(matches.empty()) {
+		printf("No events in %s\n", path);
+		return 0;
+	}
+
+	//The widest match decides the columns
+	int players = 2;
+	for(map<Uint32, MatchTally>::iterator it = matches.begin(); it != matches.end(); ++it) {
+		MatchTally& m = it->second;
+		if(m.players == 0) {m.players = max(m.playersSeen, 2);}
+		players = max(players, m.players);
+	}
+
+	MatchTally total;
+	memset(&total, 0, sizeof(total));
+	int finished = 0, wins[MAX_PLAYERS] = {};
+	long long ticks = 0;
+	if(perMatch) {
+		printf("match   seconds  winner  %-*s  %-*s  %-*s  %-*s  %-*s  %s\n", players*3-1, "sets", players*5-1, "shots", players*5-1, "hits taken",
+			players*3-1, "pickups", players*3-1, "bombs", "deaths");
+	}
+	for(map<Uint32, MatchTally>::iterator it = matches.begin(); it != matches.end(); ++it) {
+		MatchTally& m = it->second;
+		ticks += m.ticks;
+		if(m.finished) {
+			++finished;
+			if(m.winner >= 0 && m.winner < MAX_PLAYERS) {++wins[m.winner];}
+		}
+		int hits[MAX_PLAYERS] = {}, pickups[MAX_PLAYERS] = {};
+		for(int p = 0; p < MAX_PLAYERS; ++p) {
+			total.shots[p] += m.shots[p];
+			total.bombs[p] += m.bombs[p];
+			total.deaths[p] += m.deaths[p];
+			total.sets[p] += m.sets[p];
+			for(int c = 0; c < TOTAL_HIT_CAUSES; ++c) {
+				total.hits[p][c] += m.hits[p][c];
+				hits[p] += m.hits[p][c];
+			}
+			for(int j = 0; j < NPOWERUPS; ++j) {
+				total.pickups[p][j] += m.pickups[p][j];
+				pickups[p] += m.pickups[p][j];
+			}
+		}
+		total.detonations += m.detonations;
+		total.tiedSets += m.tiedSets;
+
+		if(perMatch) {
+			char winner[8];
+			snprintf(winner, sizeof(winner), m.winner >= 0 ? "P%d" : "-", m.winner+1);
+			printf("%5u  %8.1f  %6s  %-*s  %-*s  %-*s  %-*s  %-*s  %s\n", it->first, (double) m.ticks/TICK_RATE, m.finished ? winner : "-",
+				players*3-1, perPlayer(m.sets, m.players, 2).c_str(), players*5-1, perPlayer(m.shots, m.players, 4).c_str(),
+				players*5-1, perPlayer(hits, m.players, 4).c_str(), players*3-1, perPlayer(pickups, m.players, 2).c_str(),
+				players*3-1, perPlayer(m.bombs, m.players, 2).c_str(), perPlayer(m.deaths, m.players, 2).c_str());
+		}
+	}
+
+	double n = matches.size();
+	printf("%lld events, %d matches (%d finished):", events, (int) matches.size(), finished);
+	for(int p = 0; p < players; ++p) {
+		printf(" player %d won %d%s", p+1, wins[p], p+1 < players ? "," : "\n");
+	}
+	printf("Average match length %.1f s, %.2f sets tied per match, %.2f detonations per match\n", ticks/n/TICK_RATE, total.tiedSets/n, total.detonations/n);
+	for(int p = 0; p < players; ++p) {
+		printf("Player %d per match: %.2f sets, %.1f shots, %.2f bombs, %.2f deaths\n", p+1, total.sets[p]/n, total.shots[p]/n, total.bombs[p]/n, total.deaths[p]/n);
+		printf("  Hits taken:");
+		for(int c = 0; c < TOTAL_HIT_CAUSES; ++c) {
+			printf(" %s %.2f%s", causeNames[c], total.hits[p][c]/n, c+1 < TOTAL_HIT_CAUSES ? "," : "\n");
+		}
+		printf("  Pickups:");
+		for(int j = 0; j < NPOWERUPS; ++j) {
+			printf(" %s %.2f%s", powerUpNames[j], total.pickups[p][j]/n, j+1 < NPOWERUPS ? "," : "\n");
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include "tilecanvas.h"
+#include "bundle.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+//What colour keyed (white) sprite pixels show through to: renderGame clears with the scoreboard teal
+static const Uint32 BACKGROUND = 0xFF008080;
+
+TileCanvas::TileCanvas():
+	pixels(SCREEN_WIDTH*PLAYFIELD_HEIGHT, BACKGROUND), texture(NULL), cellsDrawn(0), rowsUploaded(0) {
+	invalidate();
+}
+
+TileCanvas::~TileCanvas() {
+	free();
+}
+
+bool TileCanvas::load(string sheetPath) {
+	free();
+
+	SDL_Surface* loadedSurface = IMG_Load_RW(openAsset(sheetPath), 1);
+	if(loadedSurface == NULL) {
+		ERROR_LOG(LOG_ASSETS, "Unable to load image %s! SDL_image Error: %s", sheetPath.c_str(), IMG_GetError());
+		return false;
+	}
+	SDL_Surface* sheet = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_ARGB8888, 0);
+	SDL_FreeSurface(loadedSurface);
+	if(sheet == NULL) {
+		ERROR_LOG(LOG_ASSETS, "Unable to convert %s! SDL Error: %s", sheetPath.c_str(), SDL_GetError());
+		return false;
+	}
+
+	//Scale (nearest pixel) and turn every variant now, the way Tile::render has SDL do it each frame
+	SDL_LockSurface(sheet);
+	for(int type = 0; type < TOTAL_TILES; ++type) {
+		for(int f = 0; f < FRAMES; ++f) {
+			SDL_Rect src = gTiles[type]->getRenderSrc(f*2);
+			int turns = gTiles[type]->getDirection();
+			Uint32* out = variants[type][f];
+			for(int y = 0; y < Tile::HEIGHT; ++y) {
+				for(int x = 0; x < Tile::WIDTH; ++x) {
+					//Undo the clockwise quarter turns to find where this pixel comes from
+					int ux = x, uy = y;
+					for(int t = 0; t < turns; ++t) {
+						int px = ux;
+						ux = uy;
+						uy = Tile::WIDTH-1-px;
+					}
+					int sx = min(src.x+ux*src.w/Tile::WIDTH, sheet->w-1);
+					int sy = min(src.y+uy*src.h/Tile::HEIGHT, sheet->h-1);
+					Uint32 pixel = ((Uint32*) ((Uint8*) sheet->pixels+sy*sheet->pitch))[sx];
+					out[y*Tile::WIDTH+x] = (pixel & 0xFFFFFF) == 0xFFFFFF ? BACKGROUND : pixel | 0xFF000000;
+				}
+			}
+		}
+	}
+	SDL_UnlockSurface(sheet);
+	SDL_FreeSurface(sheet);
+
+	texture = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, PLAYFIELD_HEIGHT);
+	if(texture == NULL) {
+		ERROR_LOG(LOG_RENDER, "Unable to create tile canvas texture! SDL Error: %s", SDL_GetError());
+		return false;
+	}
+	invalidate();
+	return true;
+}
+
+void TileCanvas::invalidate() {
+	for(int i = 0; i < Map::COLS; ++i) {
+		for(int j = 0; j < Map::ROWS; ++j) {
+			shown[i][j] = -1;
+		}
+	}
+}
+
+void TileCanvas::render(Map& map, int frame) {
+	for(int j = 0; j < Map::ROWS; ++j) {
+		dirtyLeft[j] = Map::COLS;
+		dirtyRight[j] = -1;
+	}
+
+	//Copy the cells whose tile or animation frame changed
+	for(int i = 0; i < Map::COLS; ++i) {
+		for(int j = 0; j < Map::ROWS; ++j) {
+			Tile* tile = map.tileMap[i][j];
+			int type = tile->getTileType();
+			int f = frame/2%tile->getFrames();
+			if(shown[i][j] == type*FRAMES+f) {continue;}
+			shown[i][j] = type*FRAMES+f;
+
+			const Uint32* src = variants[type][f];
+			Uint32* dst = &pixels[j*Tile::HEIGHT*SCREEN_WIDTH+i*Tile::WIDTH];
+			for(int y = 0; y < Tile::HEIGHT; ++y) {
+				memcpy(dst+y*SCREEN_WIDTH, src+y*Tile::WIDTH, Tile::WIDTH*sizeof(Uint32));
+			}
+			++cellsDrawn;
+			dirtyLeft[j] = min(dirtyLeft[j], i);
+			dirtyRight[j] = max(dirtyRight[j], i);
+		}
+	}
+
+	//Upload only the changed span of each tile row
+	for(int j = 0; j < Map::ROWS; ++j) {
+		if(dirtyRight[j] < 0) {continue;}
+		SDL_Rect dirty = {dirtyLeft[j]*Tile::WIDTH, j*Tile::HEIGHT, (dirtyRight[j]-dirtyLeft[j]+1)*Tile::WIDTH, Tile::HEIGHT};
+		SDL_UpdateTexture(texture, &dirty, &pixels[dirty.y*SCREEN_WIDTH+dirty.x], SCREEN_WIDTH*sizeof(Uint32));
+		++rowsUploaded;
+	}
+
+	SDL_Rect area = {0, 0, Map::COLS*Tile::WIDTH, Map::ROWS*Tile::HEIGHT};
+	SDL_RenderCopy(gRenderer, texture, &area, &area);
+}
+
+void TileCanvas::free() {
+	if(texture != NULL) {
+		SDL_DestroyTexture(texture);
+		texture = NULL;
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef TILECANVAS_H
+#define TILECANVAS_H
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+//Draws the playfield tiles on the CPU, for machines where SDL falls back to its software renderer and
+//hundreds of rotated, scaled SDL_RenderCopyEx calls a frame are slow. Every tile is scaled and rotated
+//once at load time; a frame then only copies the cells that changed since the last one, row by row with
+//memcpy, uploads those rows to a streaming texture and draws it with a single plain copy.
+class TileCanvas{
+	public:
+		static const int FRAMES = 4;	//Most animation frames a tile has
+
+	private:
+		//Each tile type and animation frame, already Tile::WIDTH x Tile::HEIGHT and facing its direction
+		Uint32 variants[TOTAL_TILES][FRAMES][Tile::WIDTH*Tile::HEIGHT];
+
+		vector<Uint32> pixels;	//The playfield, SCREEN_WIDTH x PLAYFIELD_HEIGHT, ARGB
+		Sint16 shown[Map::COLS][Map::ROWS];	//Variant each cell holds (type*FRAMES+frame), -1 if none yet
+		int dirtyLeft[Map::ROWS], dirtyRight[Map::ROWS];	//Changed cells of each row since the last upload
+		SDL_Texture* texture;
+
+	public:
+		//Cells copied and texture rows uploaded so far; for benchmarks
+		int cellsDrawn;
+		int rowsUploaded;
+
+		TileCanvas();
+		~TileCanvas();
+
+		//Builds the tile variants from the sprite sheet and creates the framebuffer texture; needs gRenderer
+		bool load(string sheetPath);
+
+		//Draws the map into the current viewport as it looks at the given tick
+		void render(Map&, int frame);
+
+		//Forget what is on the canvas, so the next render redraws every cell
+		void invalidate();
+
+		void free();
+};
+
+#endif